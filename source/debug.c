@@ -1,7 +1,7 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #include "debug.h"
@@ -56,12 +56,18 @@ static int format_specifier_arg_append(char* buffer, const char* specifier, va_l
 
     return sprintf(buffer, "%ld", arg);
   }
-  else if(!strncmp(specifier, "lld", 2))
+  else if(!strncmp(specifier, "lld", 3))
   {
     long long int arg = va_arg(args, long long int);
 
     return sprintf(buffer, "%lld", arg);
   }
+  else if(!strncmp(specifier, "llu", 3))
+  {
+    unsigned long long int arg = va_arg(args, unsigned long long int);
+
+    return sprintf(buffer, "%llu", arg);
+  }
   else if(!strncmp(specifier, "c", 1))
   {
     // ‘char’ is promoted to ‘int’ when passed through ‘...’
@@ -0,0 +1,136 @@
+/*
+ * Generate the lookup tables as const arrays in C
+ *
+ * The tables are filled in by the same init functions as at startup,
+ * and printed to stdout, so the makefile can compile them into the program
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "../treestump/piece-intern.h"
+
+struct args args =
+{
+  .debug   = false,
+  .attacks = NULL
+};
+
+/*
+ * Print a table of boards, row by row
+ *
+ * A table with more dimensions is printed as one row of boards,
+ * which C fills into the dimensions in order
+ *
+ * PARAMS
+ * - const char* name   | The name of the table
+ * - const char* size   | The dimensions of the table, ex: [2][BOARD_SQUARES]
+ * - const U64*  table  | The boards of the table
+ * - int         amount | The total amount of boards in the table
+ */
+static void board_table_print(const char* name, const char* size, const U64* table, int amount)
+{
+  printf("const U64 %s%s =\n{", name, size);
+
+  for(int index = 0; index < amount; index++)
+  {
+    if(index % 4 == 0) printf("\n ");
+
+    printf(" 0x%016llxULL,", table[index]);
+  }
+
+  printf("\n};\n\n");
+}
+
+/*
+ * Print a table of numbers, row by row
+ */
+static void int_table_print(const char* name, const char* size, const int* table, int amount)
+{
+  printf("const int %s%s =\n{", name, size);
+
+  for(int index = 0; index < amount; index++)
+  {
+    if(index % 8 == 0) printf("\n ");
+
+    printf(" %6d,", table[index]);
+  }
+
+  printf("\n};\n\n");
+}
+
+/*
+ * Print the masks and the relevant bits
+ */
+static void masks_print(void)
+{
+  masks_init();
+
+  relevant_bits_init();
+
+  board_table_print("MASKS_BISHOP", "[BOARD_SQUARES]",    MASKS_BISHOP,     BOARD_SQUARES);
+  board_table_print("MASKS_ROOK",   "[BOARD_SQUARES]",    MASKS_ROOK,       BOARD_SQUARES);
+  board_table_print("MASKS_PAWN",   "[2][BOARD_SQUARES]", MASKS_PAWN[0], 2 * BOARD_SQUARES);
+  board_table_print("MASKS_KNIGHT", "[BOARD_SQUARES]",    MASKS_KNIGHT,     BOARD_SQUARES);
+  board_table_print("MASKS_KING",   "[BOARD_SQUARES]",    MASKS_KING,       BOARD_SQUARES);
+
+  int_table_print("RELEVANT_BITS_BISHOP", "[BOARD_SQUARES]", RELEVANT_BITS_BISHOP, BOARD_SQUARES);
+  int_table_print("RELEVANT_BITS_ROOK",   "[BOARD_SQUARES]", RELEVANT_BITS_ROOK,   BOARD_SQUARES);
+}
+
+/*
+ * Print the lines from every square to every other square
+ */
+static void board_lines_print(void)
+{
+  board_lines_init();
+
+  board_table_print("BOARD_LINES", "[BOARD_SQUARES][BOARD_SQUARES]", BOARD_LINES[0], BOARD_SQUARES * BOARD_SQUARES);
+}
+
+/*
+ * Print the fancy attacks tables, one for every backend
+ *
+ * The plain attacks tables are not generated,
+ * because they are mostly empty and too large
+ */
+static void attacks_print(void)
+{
+#ifndef ATTACKS_PLAIN
+  attacks_tables_init(ATTACKS_BACKEND_MAGIC);
+
+  int_table_print("OFFSETS_BISHOP", "[BOARD_SQUARES]", OFFSETS_BISHOP, BOARD_SQUARES);
+  int_table_print("OFFSETS_ROOK",   "[BOARD_SQUARES]", OFFSETS_ROOK,   BOARD_SQUARES);
+
+  board_table_print("ATTACKS_TABLE_MAGIC", "[ATTACKS_TABLE_SIZE]", ATTACKS_TABLE, ATTACKS_TABLE_SIZE);
+
+#ifdef __x86_64__
+  attacks_tables_init(ATTACKS_BACKEND_PEXT);
+
+  board_table_print("ATTACKS_TABLE_PEXT", "[ATTACKS_TABLE_SIZE]", ATTACKS_TABLE, ATTACKS_TABLE_SIZE);
+#endif // __x86_64__
+#endif // ATTACKS_PLAIN
+}
+
+/*
+ * This is the main function
+ */
+int main(int argc, char* argv[])
+{
+  printf("/*\n * Generated by tables-generate, do not edit\n */\n\n");
+
+  printf("#include \"../source/treestump.h\"\n\n");
+
+  printf("#include \"../source/treestump/piece-intern.h\"\n\n");
+
+  masks_print();
+
+  board_lines_print();
+
+  attacks_print();
+
+  return 0;
+}
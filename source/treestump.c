@@ -3,7 +3,7 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #include "treestump.h"
@@ -14,13 +14,41 @@ static char args_doc[] = "";
 
 static struct argp_option options[] =
 {
-  { "debug", 'd', 0, 0, "Print debug messages" },
+  { "debug",    'd', 0,           0, "Print debug messages" },
+  { "attacks",  'a', "BACKEND",   0, "Sliding attacks backend (magic, pext)" },
+  { "analyse",  'A', "FILE",      0, "Analyse every position in an epd file, and quit" },
+  { "output",   'o', "FILE",      0, "Write the analysis to a file, instead of stdout" },
+  { "depth",    'D', "DEPTH",     0, "Depth of the analysis" },
+  { "threads",  't', "THREADS",   0, "Threads of the analysis, every processor by default" },
+  { "pack",     'p', "FILE",      0, "Pack the fens of a file into the output file, and quit" },
+  { "unpack",   'u', "FILE",      0, "Write the fens of a packed file to the output, and quit" },
+  { "selfplay", 'S', "FILE",      0, "Play a match from the openings in an epd file, and quit" },
+  { "games",    'g', "GAMES",     0, "Most games of the match" },
+  { "first",    '1', "LIMITS",    0, "Limits of every move of the first side, the only difference between the sides, ex: \"nodes 20000\"" },
+  { "second",   '2', "LIMITS",    0, "Limits of every move of the second side, ex: \"movetime 50\"" },
+  { "sprt",     's', "ELO0:ELO1", 0, "Elo bounds of the test of the match, 0:5 by default" },
+  { "datagen",  'G', "POSITIONS", 0, "Write packed positions from selfplay games to the output file, and quit" },
+  { "nodes",    'n', "NODES",     0, "Nodes of every move of the generated games" },
   { 0 }
 };
 
 struct args args =
 {
-  .debug = false
+  .debug   = false,
+  .attacks = NULL,
+  .analyse = NULL,
+  .output  = NULL,
+  .depth   = 6,
+  .threads = 0,
+  .pack     = NULL,
+  .unpack   = NULL,
+  .selfplay = NULL,
+  .games    = 1000,
+  .first    = NULL,
+  .second   = NULL,
+  .sprt     = NULL,
+  .datagen  = 0,
+  .nodes    = 5000
 };
 
 /*
@@ -36,6 +64,62 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
       args->debug = true;
       break;
 
+    case 'a':
+      args->attacks = arg;
+      break;
+
+    case 'A':
+      args->analyse = arg;
+      break;
+
+    case 'o':
+      args->output = arg;
+      break;
+
+    case 'D':
+      args->depth = atoi(arg);
+      break;
+
+    case 't':
+      args->threads = atoi(arg);
+      break;
+
+    case 'p':
+      args->pack = arg;
+      break;
+
+    case 'u':
+      args->unpack = arg;
+      break;
+
+    case 'S':
+      args->selfplay = arg;
+      break;
+
+    case 'g':
+      args->games = atoi(arg);
+      break;
+
+    case '1':
+      args->first = arg;
+      break;
+
+    case '2':
+      args->second = arg;
+      break;
+
+    case 's':
+      args->sprt = arg;
+      break;
+
+    case 'G':
+      args->datagen = atoi(arg);
+      break;
+
+    case 'n':
+      args->nodes = atoi(arg);
+      break;
+
     case ARGP_KEY_ARG:
       break;
 
@@ -49,34 +133,110 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
   return 0;
 }
 
+/*
+ * Get the sliding attacks backend from its name
+ *
+ * If no backend is supplied, the CPU decides the backend
+ */
+static AttacksBackend attacks_backend_parse(const char* string)
+{
+  if(!string) return ATTACKS_BACKEND_AUTO;
+
+  if(strcmp(string, "magic") == 0) return ATTACKS_BACKEND_MAGIC;
+
+  if(strcmp(string, "pext") == 0)  return ATTACKS_BACKEND_PEXT;
+
+  if(args.debug) error_print("Unknown attacks backend: (%s)", string);
+
+  return ATTACKS_BACKEND_AUTO;
+}
+
+/*
+ * Parse the limits of every move of a selfplay side, ex: nodes 20000
+ *
+ * Without limits, the side searches to the depth of the depth option
+ */
+static void selfplay_limits_parse(SearchLimits* limits, const char* string)
+{
+  search_limits_init(limits);
+
+  const char* limit;
+
+  if(string && (limit = strstr(string, "depth")))    limits->depth    = atoi(limit + 6);
+
+  if(string && (limit = strstr(string, "nodes")))    limits->nodes    = atoi(limit + 6);
+
+  if(string && (limit = strstr(string, "movetime"))) limits->movetime = atoi(limit + 9);
+
+  if(limits->depth < 0 && limits->nodes < 0 && limits->movetime < 0)
+  {
+    limits->depth = args.depth;
+  }
+}
+
+/*
+ * Play the selfplay match of the arguments
+ */
+static int selfplay_run(void)
+{
+  SearchLimits limits[2];
+
+  selfplay_limits_parse(&limits[0], args.first);
+  selfplay_limits_parse(&limits[1], args.second);
+
+  double elo0 = 0.0;
+  double elo1 = 5.0;
+
+  if(args.sprt && sscanf(args.sprt, "%lf:%lf", &elo0, &elo1) != 2)
+  {
+    if(args.debug) error_print("Bad sprt bounds: (%s)", args.sprt);
+
+    return 1;
+  }
+
+  return selfplay_match(args.selfplay, args.output, limits, args.games, args.threads, elo0, elo1);
+}
+
 /*
  *
  */
 static void all_init(void)
 {
+#ifndef TABLES_GENERATED
   masks_init();
 
   relevant_bits_init();
 
-  attacks_init();
-
   board_lines_init();
+#endif // TABLES_GENERATED
+
+  attacks_init(attacks_backend_parse(args.attacks));
 
   random_keys_init();
+
+  hash_table_init(&hash_table, HASH_TABLE_DEFAULT_SIZE);
 }
 
 /*
+ * Read a line from stdin, without the line break,
+ * into a buffer that grows to fit the line
  *
+ * RETURN (bool status)
+ * - true  | A line was read
+ * - false | The end of the input
  */
-static bool stdin_string(char* string)
+static bool stdin_string(char** string, size_t* size)
 {
-  fflush(stdin);
+  ssize_t length = getline(string, size, stdin);
 
-  char buffer[1024];
+  if(length < 0) return false;
 
-  if(fgets(buffer, sizeof(buffer), stdin) == NULL) return false;
+  while(length > 0 && ((*string)[length - 1] == '\n' || (*string)[length - 1] == '\r'))
+  {
+    (*string)[--length] = '\0';
+  }
 
-  return (sscanf(buffer, "%[^\n]%*c", string) == 1);
+  return true;
 }
 
 /*
@@ -144,20 +304,72 @@ int main(int argc, char* argv[])
 
   all_init();
 
-  Position position;
-  fen_parse(&position, FEN_START);
+  if(args.analyse)
+  {
+    int status = analyse_file(args.analyse, args.output, args.depth, args.threads);
+
+    hash_table_free(&hash_table);
+
+    return status;
+  }
+
+  if(args.pack)
+  {
+    int status = args.output ? fens_file_pack(args.pack, args.output) : 1;
+
+    if(!args.output && args.debug) error_print("No output file to pack to");
 
-  char uci_string[256];
+    hash_table_free(&hash_table);
+
+    return status;
+  }
 
-  do
+  if(args.unpack)
   {
-    memset(uci_string, '\0', sizeof(uci_string));
+    int status = packed_file_unpack(args.unpack, args.output);
+
+    hash_table_free(&hash_table);
+
+    return status;
+  }
 
-    stdin_string(uci_string);
+  if(args.selfplay)
+  {
+    int status = selfplay_run();
+
+    hash_table_free(&hash_table);
+
+    return status;
+  }
+
+  if(args.datagen > 0)
+  {
+    int status = datagen_file(args.output, args.datagen, args.nodes, args.threads);
 
+    hash_table_free(&hash_table);
+
+    return status;
+  }
+
+  Position position;
+  fen_parse(&position, FEN_START);
+
+  char*  uci_string = NULL;
+  size_t uci_size   = 0;
+
+  while(stdin_string(&uci_string, &uci_size))
+  {
     uci_parse(&position, uci_string);
+
+    if(strcmp(uci_string, "quit") == 0) break;
   }
-  while(strcmp(uci_string, "quit") != 0);
+
+  // At the end of the input, the running search is finished first
+  uci_search_wait();
+
+  free(uci_string);
+
+  hash_table_free(&hash_table);
 
   if(args.debug) info_print("End of main");
 
@@ -1,7 +1,7 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #ifndef TREESTUMP_H
@@ -9,6 +9,7 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <argp.h>
 #include <signal.h>
@@ -18,7 +19,21 @@
 
 struct args
 {
-  bool debug;
+  bool  debug;
+  char* attacks;
+  char* analyse;
+  char* output;
+  int   depth;
+  int   threads;
+  char* pack;
+  char* unpack;
+  char* selfplay;
+  int   games;
+  char* first;
+  char* second;
+  char* sprt;
+  int   datagen;
+  int   nodes;
 };
 
 extern struct args args;
@@ -26,6 +41,16 @@ extern struct args args;
 typedef unsigned long long  U64;
 typedef unsigned long       U32;
 
+/*
+ * The lookup tables are const when they are generated at build time,
+ * otherwise they are filled in by the init functions at startup
+ */
+#ifdef TABLES_GENERATED
+#define TABLE_CONST const
+#else
+#define TABLE_CONST
+#endif // TABLES_GENERATED
+
 #define BOARD_SQUARE_SET(BOARD, SQUARE) ((BOARD) |  (1ULL << (SQUARE)))
 #define BOARD_SQUARE_GET(BOARD, SQUARE) ((BOARD) &  (1ULL << (SQUARE)))
 #define BOARD_SQUARE_POP(BOARD, SQUARE) ((BOARD) & ~(1ULL << (SQUARE)))
@@ -64,10 +89,16 @@ typedef enum
   CASTLE_BLACK       = CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN
 } Castle;
 
+/*
+ * The pieces are stored as 6 piece type boards and 2 side boards,
+ * a piece board is the intersection of its type board and side board
+ *
+ * Use POSITION_BOARD_GET and POSITION_COVER_GET to read the boards
+ */
 typedef struct
 {
-  U64     boards[12];
-  U64     covers[3];
+  U64     types[6];   // pieces of each type, both sides
+  U64     sides[2];   // pieces of each side
   Side    side;       // side to move
   Square  passant;    // enpassant square
   Castle  castle;     // castling rights
@@ -75,6 +106,10 @@ typedef struct
   int     turns;      // number of whole moves
 } Position;
 
+#define POSITION_BOARD_GET(POSITION, PIECE) ((POSITION).types[PIECE_TYPE_GET(PIECE)] & (POSITION).sides[PIECE_SIDE_GET(PIECE)])
+
+#define POSITION_COVER_GET(POSITION, SIDE) (((SIDE) == SIDE_BOTH) ? ((POSITION).sides[SIDE_WHITE] | (POSITION).sides[SIDE_BLACK]) : (POSITION).sides[(SIDE)])
+
 #include "treestump/piece.h"
 #include "treestump/position.h"
 #include "treestump/move.h"
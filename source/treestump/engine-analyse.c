@@ -0,0 +1,276 @@
+/*
+ * Analyse a file of positions on every core
+ *
+ * Every position gets its own single threaded search,
+ * and every thread has its own search state and hash table.
+ * The results are written in the order of the positions in the file,
+ * with the line number of the position, because bad lines are skipped
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "engine-intern.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define ANALYSE_HASH_SIZE 16
+
+/*
+ * The result of the search of one position
+ */
+typedef struct
+{
+  Move move;
+  int  score;
+  U64  nodes;
+  long time;
+  bool done;
+} AnalyseResult;
+
+/*
+ * The state that the analysing threads share
+ *
+ * lines   | The file line number of every position
+ * next    | The next position to search, taken atomically
+ * written | The amount of results that are written, guarded by the mutex
+ */
+typedef struct
+{
+  const Position* positions;
+  const size_t*   lines;
+  size_t          amount;
+  size_t          next;
+  int             depth;
+  AnalyseResult*  results;
+  size_t          written;
+  FILE*           file;
+  pthread_mutex_t mutex;
+} Analysis;
+
+/*
+ * Write the result of the position as a json line
+ *
+ * A position without legal moves has a null best move,
+ * and is scored as mate 0 or as a draw
+ */
+static void analyse_result_write(FILE* file, size_t line, Position position, const AnalyseResult* result)
+{
+  char fenString[FEN_STRING_SIZE];
+  fen_create(fenString, position);
+
+  fprintf(file, "{\"line\": %ld, \"fen\": \"%s\", ", (long) line, fenString);
+
+  if(result->move != MOVE_NONE)
+  {
+    char moveString[8];
+    move_string_create(moveString, result->move);
+
+    fprintf(file, "\"bestmove\": \"%s\", ", moveString);
+  }
+  else fprintf(file, "\"bestmove\": null, ");
+
+  if(result->score >= SCORE_MATE - SEARCH_MAX_PLY)
+  {
+    fprintf(file, "\"score\": {\"mate\": %d}, ", (SCORE_MATE - result->score + 1) / 2);
+  }
+  else if(result->score <= -SCORE_MATE + SEARCH_MAX_PLY)
+  {
+    fprintf(file, "\"score\": {\"mate\": %d}, ", -(SCORE_MATE + result->score) / 2);
+  }
+  else fprintf(file, "\"score\": {\"cp\": %d}, ", result->score);
+
+  fprintf(file, "\"nodes\": %llu, \"time\": %ld}\n", result->nodes, result->time);
+}
+
+/*
+ * Store the result of the position, and write every result
+ * that is done and comes next in order
+ */
+static void analyse_result_store(Analysis* analysis, size_t index, AnalyseResult result)
+{
+  pthread_mutex_lock(&analysis->mutex);
+
+  analysis->results[index] = result;
+  analysis->results[index].done = true;
+
+  while(analysis->written < analysis->amount && analysis->results[analysis->written].done)
+  {
+    size_t written = analysis->written++;
+
+    analyse_result_write(analysis->file, analysis->lines[written], analysis->positions[written], &analysis->results[written]);
+  }
+
+  fflush(analysis->file);
+
+  pthread_mutex_unlock(&analysis->mutex);
+}
+
+/*
+ * Search the next position, until every position is searched
+ *
+ * The hash table is cleared before every position,
+ * so the result does not depend on what the thread searched before
+ */
+static void* analyse_thread_run(void* data)
+{
+  Analysis* analysis = data;
+
+  // Without a hash table, the search still works, only slower
+  HashTable table = { .entries = NULL, .amount = 0 };
+
+  hash_table_init(&table, ANALYSE_HASH_SIZE);
+
+  SearchLimits limits;
+
+  search_limits_init(&limits);
+
+  limits.depth = analysis->depth;
+
+  Search* search = malloc(sizeof(Search));
+
+  size_t index;
+
+  while(search && (index = __atomic_fetch_add(&analysis->next, 1, __ATOMIC_RELAXED)) < analysis->amount)
+  {
+    hash_table_clear(&table);
+
+    memset(search, 0, sizeof(Search));
+
+    search->table  = &table;
+    search->limits = &limits;
+
+    long startTime = time_ms_get();
+
+    AnalyseResult result;
+
+    result.move  = best_move_search(search, analysis->positions[index]);
+    result.score = search->score;
+
+    // Without legal moves the position is mate or stalemate
+    if(result.move == MOVE_NONE)
+    {
+      result.score = position_checkers_get(&analysis->positions[index]) ? -SCORE_MATE : 0;
+    }
+    result.nodes = search->nodes;
+    result.time  = time_ms_get() - startTime;
+
+    analyse_result_store(analysis, index, result);
+  }
+
+  if(search) free(search);
+
+  hash_table_free(&table);
+
+  return NULL;
+}
+
+/*
+ * Analyse every position in the file, to the supplied depth
+ *
+ * Every json line has the line number of its position in the input file,
+ * since the lines that fail to parse are skipped
+ *
+ * PARAMS
+ * - const char* input         | File with one fen or epd per line
+ * - const char* output        | File to write json lines to, or NULL for stdout
+ * - int         depth         | The depth to search every position to
+ * - int         thread_amount | Threads to search with, or 0 for every processor
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to load the positions
+ * - 2 | Failed to open the output file
+ * - 3 | Failed to allocate the results
+ */
+int analyse_file(const char* input, const char* output, int depth, int thread_amount)
+{
+  size_t amount = 0;
+
+  size_t* lines = NULL;
+
+  Position* positions = fens_file_load(input, &amount, &lines, thread_amount);
+
+  if(!positions)
+  {
+    if(args.debug) error_print("Failed to load positions: %s", input);
+
+    return 1;
+  }
+
+  FILE* file = output ? fopen(output, "w") : stdout;
+
+  if(!file)
+  {
+    if(args.debug) error_print("Failed to open output: %s", output);
+
+    free(positions);
+
+    free(lines);
+
+    return 2;
+  }
+
+  AnalyseResult* results = calloc(amount + 1, sizeof(AnalyseResult));
+
+  if(!results)
+  {
+    if(file != stdout) fclose(file);
+
+    free(positions);
+
+    free(lines);
+
+    return 3;
+  }
+
+  Analysis analysis =
+  {
+    .positions = positions,
+    .lines     = lines,
+    .amount    = amount,
+    .next      = 0,
+    .depth     = depth,
+    .results   = results,
+    .written   = 0,
+    .file      = file,
+    .mutex     = PTHREAD_MUTEX_INITIALIZER
+  };
+
+  if(thread_amount <= 0) thread_amount = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if(thread_amount <= 0) thread_amount = 1;
+
+  pthread_t threads[thread_amount];
+
+  int threadCount = 0;
+
+  for(; threadCount < thread_amount; threadCount++)
+  {
+    if(pthread_create(&threads[threadCount], NULL, analyse_thread_run, &analysis) != 0) break;
+  }
+
+  // The positions are searched by this thread, if no thread could be created
+  if(threadCount == 0) analyse_thread_run(&analysis);
+
+  for(int index = 0; index < threadCount; index++)
+  {
+    pthread_join(threads[index], NULL);
+  }
+
+  if(args.debug) info_print("Analysed %ld positions", (long) analysis.written);
+
+  if(file != stdout) fclose(file);
+
+  free(results);
+
+  free(positions);
+
+  free(lines);
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Measure the speed of the search on a fixed set of positions
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "engine-intern.h"
+
+static const char* BENCH_FENS[] =
+{
+  "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+  "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+  "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+  "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+  "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+  "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+  "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+  "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1"
+};
+
+#define BENCH_FEN_AMOUNT (sizeof(BENCH_FENS) / sizeof(*BENCH_FENS))
+
+/*
+ * Search every bench position to the supplied depth,
+ * and print the amount of nodes and the speed of the search
+ *
+ * The bench has its own hash table, which is cleared before every position,
+ * so that the same depth always gives the same amount of nodes
+ */
+void bench_test(int depth)
+{
+  SearchLimits limits;
+
+  search_limits_init(&limits);
+
+  limits.depth = depth;
+
+  // Without a hash table, the search still works, only slower
+  HashTable table = { .entries = NULL, .amount = 0 };
+
+  hash_table_init(&table, HASH_TABLE_DEFAULT_SIZE);
+
+  U64 totalNodes = 0;
+
+  long startTime = time_ms_get();
+
+  for(int index = 0; index < BENCH_FEN_AMOUNT; index++)
+  {
+    Position position;
+
+    if(fen_parse(&position, BENCH_FENS[index]) != 0) continue;
+
+    hash_table_clear(&table);
+
+    Search search;
+
+    memset(&search, 0, sizeof(search));
+
+    search.table  = &table;
+    search.limits = &limits;
+
+    best_move_search(&search, position);
+
+    printf("Position %d: %llu\n", index + 1, search.nodes);
+
+    totalNodes += search.nodes;
+  }
+
+  long time = time_ms_get() - startTime;
+
+  hash_table_free(&table);
+
+  printf("\nAttacks backend: %s\n", attacks_backend_name_get());
+
+  printf("Nodes searched: %llu\n", totalNodes);
+
+  printf("Time (ms): %ld\n", time);
+
+  printf("Nodes/second: %llu\n", (totalNodes * 1000) / (time > 0 ? time : 1));
+}
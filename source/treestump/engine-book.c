@@ -0,0 +1,257 @@
+/*
+ * Probe a polyglot opening book
+ *
+ * The book file is mapped into memory, and the entries of a position
+ * are found by binary search, since the entries are sorted by key
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "engine-intern.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * An entry is 16 bytes, with big endian numbers
+ *
+ * 0  - 7  | key
+ * 8  - 9  | move
+ * 10 - 11 | weight
+ * 12 - 15 | learn, not used
+ */
+#define BOOK_ENTRY_SIZE 16
+
+/*
+ * Read a big endian number of the supplied amount of bytes
+ */
+static U64 book_number_get(const unsigned char* bytes, int amount)
+{
+  U64 number = 0ULL;
+
+  for(int index = 0; index < amount; index++)
+  {
+    number = (number << 8) | bytes[index];
+  }
+
+  return number;
+}
+
+/*
+ *
+ */
+static U64 book_entry_key_get(const Book* book, size_t index)
+{
+  return book_number_get(book->entries + (index * BOOK_ENTRY_SIZE), 8);
+}
+
+/*
+ *
+ */
+static int book_entry_move_get(const Book* book, size_t index)
+{
+  return book_number_get(book->entries + (index * BOOK_ENTRY_SIZE) + 8, 2);
+}
+
+/*
+ *
+ */
+static int book_entry_weight_get(const Book* book, size_t index)
+{
+  return book_number_get(book->entries + (index * BOOK_ENTRY_SIZE) + 10, 2);
+}
+
+/*
+ * Map the book file into memory, without reading it
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open the file
+ * - 2 | The size of the file is not a multiple of the entry size
+ * - 3 | Failed to map the file
+ */
+int book_open(Book* book, const char* filepath)
+{
+  book_close(book);
+
+  int descriptor = open(filepath, O_RDONLY);
+
+  if(descriptor < 0)
+  {
+    if(args.debug) error_print("Failed to open book: %s", filepath);
+
+    return 1;
+  }
+
+  struct stat status;
+
+  if(fstat(descriptor, &status) != 0 || status.st_size == 0 || status.st_size % BOOK_ENTRY_SIZE != 0)
+  {
+    if(args.debug) error_print("Bad size of book: %s", filepath);
+
+    close(descriptor);
+
+    return 2;
+  }
+
+  void* memory = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+  close(descriptor);
+
+  if(memory == MAP_FAILED)
+  {
+    if(args.debug) error_print("Failed to map book: %s", filepath);
+
+    return 3;
+  }
+
+  book->entries = memory;
+  book->size    = status.st_size;
+  book->amount  = status.st_size / BOOK_ENTRY_SIZE;
+
+  // Every game can get other book moves
+  book->seed = time_ms_get() ^ getpid();
+
+  if(args.debug) info_print("Opened book with %ld entries", (long) book->amount);
+
+  return 0;
+}
+
+/*
+ * Unmap the book, if a book is open
+ */
+void book_close(Book* book)
+{
+  if(book->entries) munmap((void*) book->entries, book->size);
+
+  book->entries = NULL;
+  book->amount  = 0;
+  book->size    = 0;
+}
+
+/*
+ * Get the index of the first entry with the key,
+ * or of the first entry after it if there is none
+ */
+static size_t book_entry_index_get(const Book* book, U64 key)
+{
+  size_t lower = 0;
+  size_t upper = book->amount;
+
+  while(lower < upper)
+  {
+    size_t middle = lower + (upper - lower) / 2;
+
+    if(book_entry_key_get(book, middle) < key)
+    {
+      lower = middle + 1;
+    }
+    else upper = middle;
+  }
+
+  return lower;
+}
+
+/*
+ * Get the legal move of the polyglot move
+ *
+ * Polyglot counts the squares from A1, has the promote piece in bit 12-14,
+ * and writes castling as the king capturing its own rook
+ *
+ * RETURN (Move move)
+ * - MOVE_NONE | The move is not legal in the position
+ */
+static Move book_move_create(Position position, int bookMove)
+{
+  Square targetSquare = (bookMove & 0x3f) ^ 56;
+  Square sourceSquare = ((bookMove >> 6) & 0x3f) ^ 56;
+
+  int promote = (bookMove >> 12) & 0x7;
+
+  Piece piece = square_piece_get(position, sourceSquare);
+
+  if(PIECE_TYPE_GET(piece) == PIECE_TYPE_KING &&
+     BOARD_SQUARE_GET(position.types[PIECE_TYPE_ROOK] & position.sides[position.side], targetSquare))
+  {
+    targetSquare = (targetSquare > sourceSquare) ? (sourceSquare + 2) : (sourceSquare - 2);
+  }
+
+  MoveArray moveArray;
+  moveArray.amount = 0;
+
+  moves_create(&moveArray, position);
+
+  for(int index = 0; index < moveArray.amount; index++)
+  {
+    Move move = moveArray.moves[index];
+
+    if(MOVE_SOURCE_GET(move) != sourceSquare || MOVE_TARGET_GET(move) != targetSquare) continue;
+
+    Piece promotePiece = MOVE_PROMOTE_GET(move);
+
+    // The promote pieces of polyglot are knight 1, bishop 2, rook 3 and queen 4
+    int movePromote = (promotePiece == PIECE_WHITE_PAWN) ? 0 : PIECE_TYPE_GET(promotePiece);
+
+    if(movePromote == promote) return move;
+  }
+
+  return MOVE_NONE;
+}
+
+/*
+ * Get a move from the book, picked at random by the weights of the moves
+ *
+ * RETURN (Move move)
+ * - MOVE_NONE | The position is not in the book
+ */
+Move book_move_get(Book* book, Position position)
+{
+  if(!book->entries) return MOVE_NONE;
+
+  U64 key = polyglot_key_create(position);
+
+  size_t first = book_entry_index_get(book, key);
+
+  size_t last = first;
+
+  U64 weightSum = 0;
+
+  for(; last < book->amount && book_entry_key_get(book, last) == key; last++)
+  {
+    weightSum += book_entry_weight_get(book, last);
+  }
+
+  if(first == last) return MOVE_NONE;
+
+  // Every move is as likely, if the moves have no weights
+  bool weighted = (weightSum > 0);
+
+  if(!weighted) weightSum = last - first;
+
+  U64 pick = rand_r(&book->seed) % weightSum;
+
+  Move bestMove = MOVE_NONE;
+
+  for(size_t index = first; index < last; index++)
+  {
+    Move move = book_move_create(position, book_entry_move_get(book, index));
+
+    if(move == MOVE_NONE) continue;
+
+    if(bestMove == MOVE_NONE) bestMove = move;
+
+    U64 weight = weighted ? book_entry_weight_get(book, index) : 1;
+
+    if(pick < weight) return move;
+
+    pick -= weight;
+  }
+
+  return bestMove;
+}
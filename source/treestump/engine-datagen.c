@@ -0,0 +1,258 @@
+/*
+ * Generate training data from selfplay games on every core
+ *
+ * Every game starts with random moves from the start position,
+ * and is played with a fixed amount of nodes per move. The quiet positions
+ * of the game are written as packed positions, with the score of the search
+ * and the result of the game
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "engine-intern.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define DATAGEN_HASH_SIZE 16
+
+// The amount of random moves that every game starts with
+#define DATAGEN_RANDOM_PLIES 8
+
+// The milliseconds between every report of the throughput
+#define DATAGEN_REPORT_TIME 10000
+
+/*
+ * The state that the generating threads share
+ *
+ * written | The amount of written positions, guarded by the mutex
+ * seeds   | Taken atomically, so every thread gets its own random moves
+ */
+typedef struct
+{
+  size_t          amount;
+  SearchLimits    limits[2];
+  size_t          written;
+  int             games;
+  unsigned int    seeds;
+  long            start_time;
+  long            report_time;
+  FILE*           file;
+  pthread_mutex_t mutex;
+} Datagen;
+
+/*
+ * Create an opening by making random moves from the start position
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The game was over before the last random move
+ */
+static int datagen_opening_create(Position* position, unsigned int* seed)
+{
+  fen_parse(position, FEN_START);
+
+  for(int ply = 0; ply < DATAGEN_RANDOM_PLIES; ply++)
+  {
+    MoveArray moveArray;
+    moveArray.amount = 0;
+
+    moves_create(&moveArray, *position);
+
+    if(moveArray.amount <= 0) return 1;
+
+    move_make(position, moveArray.moves[rand_r(seed) % moveArray.amount]);
+  }
+
+  MoveArray moveArray;
+  moveArray.amount = 0;
+
+  moves_create(&moveArray, *position);
+
+  return (moveArray.amount > 0) ? 0 : 1;
+}
+
+/*
+ * Print the amount of written positions, and the positions per second
+ */
+static void datagen_report_print(const Datagen* datagen, long time)
+{
+  long elapsed = time - datagen->start_time;
+
+  double speed = (elapsed > 0) ? (datagen->written * 1000.0 / elapsed) : 0.0;
+
+  printf("Positions %zu of %zu, games %d, %.0f positions per second\n",
+    datagen->written, datagen->amount, datagen->games, speed);
+
+  fflush(stdout);
+}
+
+/*
+ * Write the positions of a game, but not more than the positions that are left
+ *
+ * RETURN (bool done)
+ * - true | Every position is written
+ */
+static bool datagen_positions_write(Datagen* datagen, const PackedPosition* packeds, int amount)
+{
+  pthread_mutex_lock(&datagen->mutex);
+
+  size_t left = datagen->amount - datagen->written;
+
+  size_t writeAmount = ((size_t) amount < left) ? (size_t) amount : left;
+
+  if(fwrite(packeds, sizeof(PackedPosition), writeAmount, datagen->file) != writeAmount)
+  {
+    if(args.debug) error_print("Failed to write positions");
+
+    // Writing more is no use, so the generation is done
+    writeAmount = left;
+  }
+
+  datagen->written += writeAmount;
+
+  datagen->games++;
+
+  long time = time_ms_get();
+
+  if(time - datagen->report_time >= DATAGEN_REPORT_TIME)
+  {
+    datagen_report_print(datagen, time);
+
+    datagen->report_time = time;
+  }
+
+  bool done = (datagen->written >= datagen->amount);
+
+  pthread_mutex_unlock(&datagen->mutex);
+
+  return done;
+}
+
+/*
+ * Play games, until enough positions are written
+ */
+static void* datagen_thread_run(void* data)
+{
+  Datagen* datagen = data;
+
+  unsigned int seed = time_ms_get() ^ getpid() ^ (__atomic_fetch_add(&datagen->seeds, 1, __ATOMIC_RELAXED) * 2654435761U);
+
+  HashTable tables[2] =
+  {
+    { .entries = NULL, .amount = 0 },
+    { .entries = NULL, .amount = 0 }
+  };
+
+  // Without hash tables, the search still works, only slower
+  hash_table_init(&tables[0], DATAGEN_HASH_SIZE);
+  hash_table_init(&tables[1], DATAGEN_HASH_SIZE);
+
+  Search* search = malloc(sizeof(Search));
+
+  PackedPosition* packeds = malloc(SELFPLAY_MAX_PLIES * sizeof(PackedPosition));
+
+  bool done = false;
+
+  while(search && packeds && !done)
+  {
+    Position opening;
+
+    if(datagen_opening_create(&opening, &seed) != 0) continue;
+
+    int amount = 0;
+
+    PackedResult result = selfplay_game_play(search, tables, datagen->limits, opening, 0, packeds, &amount);
+
+    for(int index = 0; index < amount; index++)
+    {
+      packeds[index].result = result;
+    }
+
+    done = datagen_positions_write(datagen, packeds, amount);
+  }
+
+  if(packeds) free(packeds);
+
+  if(search) free(search);
+
+  hash_table_free(&tables[0]);
+  hash_table_free(&tables[1]);
+
+  return NULL;
+}
+
+/*
+ * Generate packed positions from selfplay games
+ *
+ * PARAMS
+ * - const char* output        | File to write the packed positions to
+ * - size_t      amount        | The amount of positions to generate
+ * - int         nodes         | The nodes of every move
+ * - int         thread_amount | Threads to play with, or 0 for every processor
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open the output file
+ */
+int datagen_file(const char* output, size_t amount, int nodes, int thread_amount)
+{
+  FILE* file = output ? fopen(output, "wb") : NULL;
+
+  if(!file)
+  {
+    if(args.debug) error_print("Failed to open output: %s", output ? output : "(none)");
+
+    return 1;
+  }
+
+  Datagen datagen =
+  {
+    .amount      = amount,
+    .written     = 0,
+    .games       = 0,
+    .seeds       = 0,
+    .start_time  = time_ms_get(),
+    .file        = file,
+    .mutex       = PTHREAD_MUTEX_INITIALIZER
+  };
+
+  datagen.report_time = datagen.start_time;
+
+  search_limits_init(&datagen.limits[0]);
+
+  datagen.limits[0].nodes = nodes;
+
+  datagen.limits[1] = datagen.limits[0];
+
+  if(thread_amount <= 0) thread_amount = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if(thread_amount <= 0) thread_amount = 1;
+
+  pthread_t threads[thread_amount];
+
+  int threadCount = 0;
+
+  for(; threadCount < thread_amount; threadCount++)
+  {
+    if(pthread_create(&threads[threadCount], NULL, datagen_thread_run, &datagen) != 0) break;
+  }
+
+  // The games are played by this thread, if no thread could be created
+  if(threadCount == 0) datagen_thread_run(&datagen);
+
+  for(int index = 0; index < threadCount; index++)
+  {
+    pthread_join(threads[index], NULL);
+  }
+
+  datagen_report_print(&datagen, time_ms_get());
+
+  fclose(file);
+
+  return 0;
+}
@@ -1,22 +1,199 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #ifndef ENGINE_INTERN_H
 #define ENGINE_INTERN_H
 
+#define SEARCH_MAX_PLY 64
+
+// A selfplay game that goes on for longer is a draw
+#define SELFPLAY_MAX_PLIES 400
+
+// A mate is scored as SCORE_MATE minus the plies to it
+#define SCORE_MATE     49000
+#define SCORE_INFINITY 50000
+
+#ifdef SEARCH_STATS
+/*
+ * Counters of what happened in a search, to tune the ordering and pruning
+ *
+ * Every search has its own counters, so threads do not share them
+ *
+ * first_cutoffs | Beta cutoffs by the first move of the node
+ * depth_nodes   | The amount of nodes after every finished depth
+ */
+typedef struct
+{
+  U64 qnodes;
+  U64 cutoffs;
+  U64 first_cutoffs;
+  U64 hash_probes;
+  U64 hash_hits;
+  U64 hash_cutoffs;
+  U64 depth_nodes[SEARCH_MAX_PLY];
+  int depth;
+} SearchStats;
+
+#define SEARCH_STATS_ADD(SEARCH, COUNTER) ((SEARCH)->stats.COUNTER++)
+#else
+#define SEARCH_STATS_ADD(SEARCH, COUNTER) ((void) 0)
+#endif // SEARCH_STATS
+
+/*
+ * State of a running search, that is shared between the nodes
+ *
+ * table   | Hash table with results of earlier searched positions
+ * killers | Quiet moves that caused a beta cutoff, per ply
+ * history | Score of quiet moves that caused a beta cutoff
+ * keys    | Hash keys of the game positions, then of the nodes above
+ * limits  | When to stop the search, the time is counted from start_time
+ * info    | Print the best lines after every depth
+ * pv      | The packed principal variation from every ply, and its length
+ * score   | The score of the best line, when the search is done
+ */
+typedef struct
+{
+  U64                 nodes;
+  HashTable*          table;
+  const SearchLimits* limits;
+  long                start_time;
+  long                time_limit;
+  bool                stopped;
+  bool                info;
+  PackedMove          killers[SEARCH_MAX_PLY][2];
+  int                 history[12][BOARD_SQUARES];
+  U64                 keys[KEY_HISTORY_SIZE + SEARCH_MAX_PLY];
+  int                 key_amount;
+  int                 seldepth;
+  PackedMove          pv[SEARCH_MAX_PLY + 1][SEARCH_MAX_PLY + 1];
+  int                 pv_lengths[SEARCH_MAX_PLY + 1];
+  int                 score;
+#ifdef SEARCH_STATS
+  SearchStats         stats;
+#endif // SEARCH_STATS
+} Search;
+
+/*
+ * One of the best lines at the root, with its score and packed moves
+ */
+typedef struct
+{
+  int        score;
+  PackedMove pv[SEARCH_MAX_PLY + 1];
+  int        length;
+} RootLine;
+
+/*
+ * The squares attacked by the opponent in a node,
+ * which is only created the first time it is needed
+ *
+ * The own king is removed from the cover, so the squares
+ * behind the king are attacked by the sliders that attack the king
+ */
+typedef struct
+{
+  bool created;
+  U64  board;
+} AttackMap;
+
+/*
+ * The stages the move picker goes through,
+ * every stage creates its moves first when it is reached
+ *
+ * A node in check only picks evasions,
+ * and the quiescence search only picks the good captures
+ */
+typedef enum
+{
+  PICK_STAGE_HASH,
+  PICK_STAGE_CAPTURES_CREATE,
+  PICK_STAGE_CAPTURES_GOOD,
+  PICK_STAGE_KILLERS,
+  PICK_STAGE_QUIETS_CREATE,
+  PICK_STAGE_QUIETS,
+  PICK_STAGE_CAPTURES_BAD,
+  PICK_STAGE_DONE,
+  PICK_STAGE_EVASIONS_HASH,
+  PICK_STAGE_EVASIONS_CREATE,
+  PICK_STAGE_EVASIONS,
+  PICK_STAGE_QUIESCENCE_CREATE,
+  PICK_STAGE_QUIESCENCE
+} PickStage;
+
+typedef struct
+{
+  const Position* position;
+  const Search*   search;
+  PickStage       stage;
+  Move            hash_move;
+  Move            killers[2];
+  int             killer_index;
+  int             ply;
+  MoveArray       moves;
+  int             scores[256];
+  int             index;
+  MoveArray       bad_captures;
+  int             bad_index;
+  AttackMap       attack_map;
+  U64             checkers;
+  U64             pinned;
+} MovePicker;
+
 extern const int PIECE_SCORES[12];
 
+extern U64 create_hash_key(Position position);
+
+extern U64 polyglot_key_create(Position position);
+
+extern HashEntry* hash_table_entry_get(HashTable* table, U64 key);
+
+extern void hash_table_store(HashTable* table, U64 key, int depth, int score, HashFlag flag, Move move);
+
+
 extern int position_score_get(Position position);
 
 
 extern bool engine_move_is_legal(Position position, Move move);
 
+extern bool move_is_pseudo_legal_fast(const Position* position, Move move);
+
+extern bool move_is_legal_fast(const Position* position, Move move, U64 pinned, U64 checkers);
+
+extern U64  position_checkers_get(const Position* position);
+
+extern U64  position_pinned_get(const Position* position);
+
 extern void moves_create(MoveArray* moveArray, Position position);
 
+extern void moves_captures_create(MoveArray* moveArray, Position position, AttackMap* attack_map);
+
+extern void moves_quiets_create(MoveArray* moveArray, Position position, AttackMap* attack_map);
+
+extern void moves_evasions_create(MoveArray* moveArray, Position position, U64 checkers, AttackMap* attack_map);
+
+extern U64  attack_map_get(AttackMap* attack_map, const Position* position);
+
+
+extern bool search_is_stopped(Search* search);
+
+extern long search_time_limit_get(const SearchLimits* limits);
+
+extern Move best_move_search(Search* search, Position position);
+
+#ifdef SEARCH_STATS
+extern void search_stats_print(const Search* search);
+#endif // SEARCH_STATS
+
+extern PackedResult selfplay_game_play(Search* search, HashTable tables[2], const SearchLimits limits[2], Position position, int firstEngine, PackedPosition* packeds, int* packed_amount);
+
+
+extern void move_picker_init(MovePicker* picker, const Position* position, const Search* search, PackedMove hash_move, int ply);
+
+extern void move_picker_quiescence_init(MovePicker* picker, const Position* position, const Search* search, int ply);
 
-extern void moves_guess_order(MoveArray* moveArray, Position position);
+extern Move move_picker_next(MovePicker* picker);
 
 #endif // ENGINE_INTERN_H
@@ -0,0 +1,239 @@
+/*
+ * Search for a forced mate in a limited amount of moves
+ *
+ * The side to mate tries every move, and the other side
+ * has to be mated after every reply. The checks with the fewest replies
+ * are tried first, like the most proving nodes in proof number search
+ *
+ * The proven and refuted positions are stored in a hash table,
+ * with the amount of moves they were searched to as the depth
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "engine-intern.h"
+
+#define MATE_HASH_SIZE 16
+
+/*
+ * A move of the side to mate, scored by the amount of replies to it,
+ * and with the checks before the other moves
+ */
+typedef struct
+{
+  Move move;
+  int  score;
+} MateCandidate;
+
+static bool mate_attack(Search* search, Position position, int moves, Move* mate_move);
+
+/*
+ * Check if every reply of the side to move gets mated,
+ * in the supplied amount of moves
+ *
+ * A stopped search has not proven the mate, so it returns false
+ */
+static bool mate_defend(Search* search, Position position, int moves)
+{
+  MoveArray replies;
+  replies.amount = 0;
+
+  moves_create(&replies, position);
+
+  for(int index = 0; index < replies.amount; index++)
+  {
+    Position positionCopy = position;
+
+    move_make(&positionCopy, replies.moves[index]);
+
+    if(!mate_attack(search, positionCopy, moves, NULL)) return false;
+  }
+
+  return !search->stopped;
+}
+
+/*
+ * Sort the candidates by their score, the lowest score first
+ */
+static void mate_candidates_sort(MateCandidate* candidates, int amount)
+{
+  for(int index = 1; index < amount; index++)
+  {
+    MateCandidate candidate = candidates[index];
+
+    int other = index - 1;
+
+    for(; other >= 0 && candidates[other].score > candidate.score; other--)
+    {
+      candidates[other + 1] = candidates[other];
+    }
+
+    candidates[other + 1] = candidate;
+  }
+}
+
+/*
+ * Check if the side to move can mate in the supplied amount of moves
+ *
+ * In the last move only checks can mate, so the other moves are skipped.
+ * A move that leaves no replies without check is a stalemate
+ *
+ * A mate in fewer moves in the hash table is also a mate in these moves,
+ * and no mate in more moves means no mate in these moves
+ */
+static bool mate_attack(Search* search, Position position, int moves, Move* mate_move)
+{
+  search->nodes++;
+
+  if(moves <= 0 || search_is_stopped(search)) return false;
+
+  U64 hashKey = create_hash_key(position);
+
+  HashEntry* entry = hash_table_entry_get(search->table, hashKey);
+
+  if(entry && entry->flag == HASH_FLAG_BETA && entry->depth <= moves)
+  {
+    Move move = move_unpack(position, entry->move);
+
+    if(move != MOVE_NONE)
+    {
+      if(mate_move) *mate_move = move;
+
+      return true;
+    }
+  }
+
+  if(entry && entry->flag == HASH_FLAG_ALPHA && entry->depth >= moves) return false;
+
+  MoveArray moveArray;
+  moveArray.amount = 0;
+
+  moves_create(&moveArray, position);
+
+  MateCandidate candidates[256];
+  int amount = 0;
+
+  for(int index = 0; index < moveArray.amount; index++)
+  {
+    Move move = moveArray.moves[index];
+
+    Position positionCopy = position;
+
+    move_make(&positionCopy, move);
+
+    U64 checkers = position_checkers_get(&positionCopy);
+
+    if(moves == 1 && !checkers) continue;
+
+    MoveArray replies;
+    replies.amount = 0;
+
+    moves_create(&replies, positionCopy);
+
+    if(replies.amount <= 0)
+    {
+      if(!checkers) continue;
+
+      if(mate_move) *mate_move = move;
+
+      hash_table_store(search->table, hashKey, 1, 0, HASH_FLAG_BETA, move);
+
+      return true;
+    }
+
+    if(moves == 1) continue;
+
+    candidates[amount++] = (MateCandidate)
+    {
+      .move  = move,
+      .score = (checkers ? 0 : 256) + replies.amount
+    };
+  }
+
+  mate_candidates_sort(candidates, amount);
+
+  for(int index = 0; index < amount; index++)
+  {
+    Position positionCopy = position;
+
+    move_make(&positionCopy, candidates[index].move);
+
+    if(mate_defend(search, positionCopy, moves - 1))
+    {
+      if(mate_move) *mate_move = candidates[index].move;
+
+      hash_table_store(search->table, hashKey, moves, 0, HASH_FLAG_BETA, candidates[index].move);
+
+      return true;
+    }
+
+    if(search->stopped) return false;
+  }
+
+  hash_table_store(search->table, hashKey, moves, 0, HASH_FLAG_ALPHA, MOVE_NONE);
+
+  return false;
+}
+
+/*
+ * Search for the shortest mate in at most the mate moves of the limits,
+ * by searching for a mate in one move, then in two moves, and so on
+ *
+ * The search stops like the normal search, by the stop flag,
+ * the nodes and the time of the limits, but it only uses half of the time,
+ * so that the normal search has time left if no mate is found
+ *
+ * PARAMS
+ * - Position            position   | The position to mate from
+ * - const SearchLimits* limits     | The most moves the mate can take, and when to stop
+ * - int*                mate_moves | The amount of moves of the found mate
+ *
+ * RETURN (Move move)
+ * - MOVE_NONE | There is no forced mate in that many moves, or the search was stopped
+ */
+Move mate_move(Position position, const SearchLimits* limits, int* mate_moves)
+{
+  Search* search = malloc(sizeof(Search));
+
+  if(!search) return MOVE_NONE;
+
+  memset(search, 0, sizeof(Search));
+
+  // Without a hash table, the search still works, only slower
+  HashTable table = { .entries = NULL, .amount = 0 };
+
+  hash_table_init(&table, MATE_HASH_SIZE);
+
+  search->table      = &table;
+  search->limits     = limits;
+  search->start_time = time_ms_get();
+  search->time_limit = search_time_limit_get(limits);
+
+  if(search->time_limit > 1) search->time_limit /= 2;
+
+  Move move = MOVE_NONE;
+
+  for(int currentMoves = 1; currentMoves <= limits->mate; currentMoves++)
+  {
+    if(mate_attack(search, position, currentMoves, &move))
+    {
+      if(mate_moves) *mate_moves = currentMoves;
+
+      break;
+    }
+
+    if(search->stopped) break;
+  }
+
+  if(args.debug) info_print("Searched nodes: %llu", search->nodes);
+
+  hash_table_free(&table);
+
+  free(search);
+
+  return move;
+}
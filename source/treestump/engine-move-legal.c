@@ -3,11 +3,13 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
 
+#include "engine-intern.h"
+
 extern bool move_castle_is_pseudo_legal(Position position, Move move);
 
 extern bool move_pawn_is_pseudo_legal(Position position, Move move);
@@ -45,5 +47,234 @@ bool engine_move_is_legal(Position position, Move move)
   // If the king does not exist, the move can no way be legal
   if(king_square == SQUARE_NONE) return false;
 
-  return !square_is_attacked(moved_position, king_square, moved_position.side);
+  U64 attackers = square_attackers_get(&moved_position, king_square, POSITION_COVER_GET(moved_position, SIDE_BOTH));
+
+  return !(attackers & moved_position.sides[moved_position.side]);
+}
+
+/*
+ * Get the pieces that check the king of the side to move
+ *
+ * RETURN (U64 board)
+ */
+U64 position_checkers_get(const Position* position)
+{
+  U64 king = position->types[PIECE_TYPE_KING] & position->sides[position->side];
+
+  if(!king) return 0ULL;
+
+  U64 attackers = square_attackers_get(position, board_first_square_get(king), POSITION_COVER_GET(*position, SIDE_BOTH));
+
+  return attackers & position->sides[!position->side];
+}
+
+/*
+ * Get the own pieces that are pinned to the king of the side to move
+ *
+ * A piece is pinned if it is the only piece
+ * between the king and a rook, bishop or queen of the opponent
+ *
+ * RETURN (U64 board)
+ */
+U64 position_pinned_get(const Position* position)
+{
+  const U64* types = position->types;
+
+  U64 king = types[PIECE_TYPE_KING] & position->sides[position->side];
+
+  if(!king) return 0ULL;
+
+  Square king_square = board_first_square_get(king);
+
+  U64 enemies = position->sides[!position->side];
+  U64 cover   = POSITION_COVER_GET(*position, SIDE_BOTH);
+
+  // The sliders that would attack the king, if no own pieces were in the way
+  U64 snipers = 0ULL;
+
+  snipers |= attacks_rook_cover_get  (king_square, enemies) & (types[PIECE_TYPE_ROOK]   | types[PIECE_TYPE_QUEEN]);
+  snipers |= attacks_bishop_cover_get(king_square, enemies) & (types[PIECE_TYPE_BISHOP] | types[PIECE_TYPE_QUEEN]);
+
+  snipers &= enemies;
+
+  U64 pinned = 0ULL;
+
+  while(snipers)
+  {
+    Square sniper_square = board_first_square_pop(&snipers);
+
+    U64 between = BOARD_LINES[king_square][sniper_square] & cover;
+
+    if(board_bit_amount_get(between) == 1) pinned |= (between & position->sides[position->side]);
+  }
+
+  return pinned;
+}
+
+/*
+ * Check if a pawn move is pseudo legal, with a few board tests
+ */
+static bool move_pawn_is_pseudo_legal_fast(const Position* position, Move move, bool capture)
+{
+  Square source_square = MOVE_SOURCE_GET(move);
+  Square target_square = MOVE_TARGET_GET(move);
+
+  Side side = position->side;
+
+  int forward = (side == SIDE_WHITE) ? -BOARD_FILES : BOARD_FILES;
+
+  bool promote_rank = (side == SIDE_WHITE) ? (target_square <= H8) : (target_square >= A1);
+
+  // A pawn promotes if, and only if, it reaches the last rank
+  if(((move & MOVE_MASK_PROMOTE) ? true : false) != promote_rank) return false;
+
+  if(move & MOVE_MASK_PROMOTE)
+  {
+    Piece promote = MOVE_PROMOTE_GET(move);
+
+    if(promote < PIECE_CREATE(PIECE_TYPE_KNIGHT, side) || promote > PIECE_CREATE(PIECE_TYPE_QUEEN, side)) return false;
+  }
+
+  U64 target_board = (1ULL << target_square);
+
+  if(move & MOVE_MASK_PASSANT)
+  {
+    return (target_square == position->passant) && (attacks_pawn_get(source_square, side) & target_board);
+  }
+
+  if(capture) return (attacks_pawn_get(source_square, side) & target_board);
+
+  if(move & MOVE_MASK_DOUBLE)
+  {
+    bool start_rank = (side == SIDE_WHITE) ? (source_square >= A2) : (source_square <= H7);
+
+    U64 middle_board = (1ULL << (source_square + forward));
+
+    return start_rank && ((int) target_square == (int) source_square + 2 * forward) &&
+           !(POSITION_COVER_GET(*position, SIDE_BOTH) & (middle_board | target_board));
+  }
+
+  return ((int) target_square == (int) source_square + forward);
+}
+
+/*
+ * Check if a move, from ex: the hash table or the killer moves,
+ * is pseudo legal in position, with a few board tests
+ *
+ * Unlike move_is_legal, the move must have the flags
+ * that the move generator would give it
+ *
+ * RETURN (bool result)
+ * - true  | The move can be made, if it does not leave the king in check
+ * - false | The move can not be made
+ */
+bool move_is_pseudo_legal_fast(const Position* position, Move move)
+{
+  Square source_square = MOVE_SOURCE_GET(move);
+  Square target_square = MOVE_TARGET_GET(move);
+
+  Piece piece = MOVE_PIECE_GET(move);
+
+  if(piece >= PIECE_NONE || PIECE_SIDE_GET(piece) != position->side) return false;
+
+  if(!BOARD_SQUARE_GET(POSITION_BOARD_GET(*position, piece), source_square)) return false;
+
+  // A piece can not move to a square of an own piece
+  if(BOARD_SQUARE_GET(position->sides[position->side], target_square)) return false;
+
+  bool capture = BOARD_SQUARE_GET(position->sides[!position->side], target_square);
+
+  if(((move & MOVE_MASK_CAPTURE) ? true : false) != capture) return false;
+
+  PieceType type = PIECE_TYPE_GET(piece);
+
+  if(type == PIECE_TYPE_PAWN) return move_pawn_is_pseudo_legal_fast(position, move, capture);
+
+  if(move & (MOVE_MASK_PROMOTE | MOVE_MASK_PASSANT | MOVE_MASK_DOUBLE)) return false;
+
+  if(move & MOVE_MASK_CASTLE)
+  {
+    return (type == PIECE_TYPE_KING) && move_castle_is_pseudo_legal(*position, move);
+  }
+
+  U64 cover = POSITION_COVER_GET(*position, SIDE_BOTH);
+
+  U64 attacks;
+
+  switch(type)
+  {
+    case PIECE_TYPE_KNIGHT:
+      attacks = attacks_knight_get(source_square);
+      break;
+
+    case PIECE_TYPE_BISHOP:
+      attacks = attacks_bishop_cover_get(source_square, cover);
+      break;
+
+    case PIECE_TYPE_ROOK:
+      attacks = attacks_rook_cover_get(source_square, cover);
+      break;
+
+    case PIECE_TYPE_QUEEN:
+      attacks = attacks_queen_cover_get(source_square, cover);
+      break;
+
+    default:
+      attacks = attacks_king_get(source_square);
+      break;
+  }
+
+  return BOARD_SQUARE_GET(attacks, target_square);
+}
+
+/*
+ * Check if a pseudo legal move is legal in position
+ *
+ * Most moves can not leave the king in check,
+ * so only king moves, pinned pieces and enpassant have to be checked.
+ * Only enpassant, which removes two pieces from a line, has to make the move
+ *
+ * PARAMS
+ * - U64 pinned   | The own pieces that are pinned to the king
+ * - U64 checkers | The pieces that check the king
+ */
+bool move_is_legal_fast(const Position* position, Move move, U64 pinned, U64 checkers)
+{
+  if(move & MOVE_MASK_PASSANT) return engine_move_is_legal(*position, move);
+
+  Square source_square = MOVE_SOURCE_GET(move);
+  Square target_square = MOVE_TARGET_GET(move);
+
+  U64 king = position->types[PIECE_TYPE_KING] & position->sides[position->side];
+
+  if(!king) return false;
+
+  // Castling has already checked every square the king moves over
+  if(move & MOVE_MASK_CASTLE) return true;
+
+  if(BOARD_SQUARE_GET(king, source_square))
+  {
+    // The king itself is removed from the cover, so it can not move along the line of a slider
+    U64 cover = POSITION_COVER_GET(*position, SIDE_BOTH) & ~king;
+
+    return !(square_attackers_get(position, target_square, cover) & position->sides[!position->side]);
+  }
+
+  Square king_square = board_first_square_get(king);
+
+  if(checkers)
+  {
+    // If more than one piece checks the king, only the king can move
+    if(checkers & (checkers - 1)) return false;
+
+    Square checker_square = board_first_square_get(checkers);
+
+    if(!BOARD_SQUARE_GET(checkers | BOARD_LINES[king_square][checker_square], target_square)) return false;
+  }
+
+  if(!BOARD_SQUARE_GET(pinned, source_square)) return true;
+
+  // A pinned piece can only move along the line between the king and the pinning piece
+  return BOARD_SQUARE_GET(BOARD_LINES[king_square][target_square], source_square) ||
+         BOARD_SQUARE_GET(BOARD_LINES[king_square][source_square], target_square);
 }
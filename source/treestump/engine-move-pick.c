@@ -0,0 +1,401 @@
+/*
+ * Pick moves one at a time, in stages
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "engine-intern.h"
+
+/*
+ * Get the score of a piece, no matter the side of the piece
+ */
+static int piece_value_get(Piece piece)
+{
+  if(piece >= PIECE_BLACK_PAWN && piece <= PIECE_BLACK_KING)
+  {
+    return PIECE_SCORES[piece - PIECE_BLACK_PAWN];
+  }
+  else if(piece >= PIECE_WHITE_PAWN && piece <= PIECE_WHITE_KING)
+  {
+    return PIECE_SCORES[piece];
+  }
+  else return 0;
+}
+
+/*
+ * Get the piece being captured by the move
+ *
+ * An enpassant move captures a pawn, even though the target square is empty
+ */
+static Piece move_capture_piece_get(Position position, Move move)
+{
+  if(move & MOVE_MASK_PASSANT)
+  {
+    return (position.side == SIDE_WHITE) ? PIECE_BLACK_PAWN : PIECE_WHITE_PAWN;
+  }
+
+  return square_piece_get(position, MOVE_TARGET_GET(move));
+}
+
+/*
+ * Guess the score of a capture or queen promotion,
+ * the most valuable victim and the least valuable attacker goes first
+ */
+static int capture_score_guess(Position position, Move move)
+{
+  int score = 0;
+
+  Piece targetPiece = move_capture_piece_get(position, move);
+
+  if(targetPiece != PIECE_NONE)
+  {
+    int sourcePieceScore = piece_value_get(MOVE_PIECE_GET(move));
+    int targetPieceScore = piece_value_get(targetPiece);
+
+    score += ((10 * targetPieceScore) - sourcePieceScore);
+  }
+
+  if(move & MOVE_MASK_PROMOTE)
+  {
+    score += piece_value_get(MOVE_PROMOTE_GET(move));
+  }
+
+  return score;
+}
+
+/*
+ * Check if a capture is likely to lose material
+ *
+ * The capture is bad if a more valuable piece captures
+ * a less valuable piece, which is defended by the enemy
+ */
+static bool capture_is_bad(Position position, Move move)
+{
+  if(move & MOVE_MASK_PROMOTE) return false;
+
+  int sourcePieceScore = piece_value_get(MOVE_PIECE_GET(move));
+  int targetPieceScore = piece_value_get(move_capture_piece_get(position, move));
+
+  if(targetPieceScore >= sourcePieceScore) return false;
+
+  return square_is_attacked(position, MOVE_TARGET_GET(move), !position.side);
+}
+
+/*
+ * Unpack a move from outside the move generator,
+ * like the hash move or a killer move, if it can be made in the position
+ *
+ * RETURN (Move move)
+ * - MOVE_NONE | The move can not be made in the position
+ */
+static Move move_pickable_unpack(const MovePicker* picker, PackedMove packed)
+{
+  // The move might come from another position,
+  // so the piece on the source square decides the moving piece
+  Move move = move_unpack(*picker->position, packed);
+
+  if(move == MOVE_NONE) return MOVE_NONE;
+
+  if(!move_is_pseudo_legal_fast(picker->position, move)) return MOVE_NONE;
+
+  return move_is_legal_fast(picker->position, move, picker->pinned, picker->checkers) ? move : MOVE_NONE;
+}
+
+/*
+ * Guess the scores of all the captures in the picker
+ */
+static void captures_scores_guess(MovePicker* picker)
+{
+  for(int index = 0; index < picker->moves.amount; index++)
+  {
+    picker->scores[index] = capture_score_guess(*picker->position, picker->moves.moves[index]);
+  }
+}
+
+/*
+ * Get the scores of all the quiet moves in the picker from the history
+ */
+static void quiets_scores_guess(MovePicker* picker)
+{
+  for(int index = 0; index < picker->moves.amount; index++)
+  {
+    Move move = picker->moves.moves[index];
+
+    picker->scores[index] = picker->search->history[MOVE_PIECE_GET(move)][MOVE_TARGET_GET(move)];
+  }
+}
+
+/*
+ * Guess the scores of all the evasions in the picker,
+ * the captures go first and the quiet moves are ordered by the history
+ */
+static void evasions_scores_guess(MovePicker* picker)
+{
+  for(int index = 0; index < picker->moves.amount; index++)
+  {
+    Move move = picker->moves.moves[index];
+
+    if(move & (MOVE_MASK_CAPTURE | MOVE_MASK_PASSANT | MOVE_MASK_PROMOTE))
+    {
+      picker->scores[index] = (1 << 24) + capture_score_guess(*picker->position, move);
+    }
+    else
+    {
+      picker->scores[index] = picker->search->history[MOVE_PIECE_GET(move)][MOVE_TARGET_GET(move)];
+    }
+  }
+}
+
+/*
+ * Select the move with the best score of the moves left in the picker,
+ * and swap it to the current index
+ *
+ * Only the moves that are picked gets sorted,
+ * instead of sorting all the moves before the first one is searched
+ *
+ * RETURN (Move move)
+ * - MOVE_NONE | No moves are left
+ */
+static Move move_best_select(MovePicker* picker)
+{
+  if(picker->index >= picker->moves.amount) return MOVE_NONE;
+
+  int bestIndex = picker->index;
+
+  for(int index = picker->index + 1; index < picker->moves.amount; index++)
+  {
+    if(picker->scores[index] > picker->scores[bestIndex]) bestIndex = index;
+  }
+
+  Move bestMove = picker->moves.moves[bestIndex];
+  int bestScore = picker->scores[bestIndex];
+
+  picker->moves.moves[bestIndex] = picker->moves.moves[picker->index];
+  picker->scores[bestIndex]      = picker->scores[picker->index];
+
+  picker->moves.moves[picker->index] = bestMove;
+  picker->scores[picker->index]      = bestScore;
+
+  picker->index++;
+
+  return bestMove;
+}
+
+/*
+ * Check if the move has already been picked in an earlier stage
+ */
+static bool move_is_picked(MovePicker* picker, Move move)
+{
+  if(move == picker->hash_move) return true;
+
+  if(picker->stage <= PICK_STAGE_KILLERS) return false;
+
+  return (move == picker->killers[0] || move == picker->killers[1]);
+}
+
+/*
+ * Initialize the move picker for a node in the search
+ *
+ * If the king is in check, only evasions are picked
+ *
+ * PARAMS
+ * - PackedMove hash_move | The best move from earlier searches (can be PACKED_MOVE_NONE)
+ * - int        ply       | The distance from the root, to get the killer moves
+ */
+void move_picker_init(MovePicker* picker, const Position* position, const Search* search, PackedMove hash_move, int ply)
+{
+  picker->position = position;
+  picker->search   = search;
+  picker->checkers = position_checkers_get(position);
+  picker->pinned   = position_pinned_get(position);
+  picker->stage    = picker->checkers ? PICK_STAGE_EVASIONS_HASH : PICK_STAGE_HASH;
+
+  picker->hash_move = move_pickable_unpack(picker, hash_move);
+
+  picker->killers[0] = MOVE_NONE;
+  picker->killers[1] = MOVE_NONE;
+  picker->killer_index = 0;
+  picker->ply = ply;
+
+  picker->moves.amount = 0;
+  picker->index = 0;
+
+  picker->bad_captures.amount = 0;
+  picker->bad_index = 0;
+
+  picker->attack_map.created = false;
+}
+
+/*
+ * Initialize the move picker for a node in the quiescence search
+ *
+ * Only the good captures and queen promotions are picked,
+ * unless the king is in check, then all evasions are picked
+ */
+void move_picker_quiescence_init(MovePicker* picker, const Position* position, const Search* search, int ply)
+{
+  move_picker_init(picker, position, search, PACKED_MOVE_NONE, ply);
+
+  picker->stage = picker->checkers ? PICK_STAGE_EVASIONS_CREATE : PICK_STAGE_QUIESCENCE_CREATE;
+}
+
+/*
+ * Pick the next move to search in the node
+ *
+ * The moves of a stage is only created when the stage is reached,
+ * so if a move causes a cutoff, the next stages are never created
+ *
+ * RETURN (Move move)
+ * - MOVE_NONE | No legal moves are left
+ */
+Move move_picker_next(MovePicker* picker)
+{
+  Move move;
+
+  switch(picker->stage)
+  {
+    case PICK_STAGE_HASH:
+      picker->stage++;
+
+      if(picker->hash_move != MOVE_NONE) return picker->hash_move;
+
+      // fall through
+
+    case PICK_STAGE_CAPTURES_CREATE:
+      moves_captures_create(&picker->moves, *picker->position, &picker->attack_map);
+
+      captures_scores_guess(picker);
+
+      picker->stage++;
+
+      // fall through
+
+    case PICK_STAGE_CAPTURES_GOOD:
+      while((move = move_best_select(picker)) != MOVE_NONE)
+      {
+        if(move_is_picked(picker, move)) continue;
+
+        // Bad captures are saved and picked after the quiet moves
+        if(capture_is_bad(*picker->position, move))
+        {
+          picker->bad_captures.moves[picker->bad_captures.amount++] = move;
+
+          continue;
+        }
+
+        return move;
+      }
+
+      picker->stage++;
+
+      // fall through
+
+    case PICK_STAGE_KILLERS:
+      while(picker->killer_index < 2)
+      {
+        PackedMove killer = picker->search->killers[picker->ply][picker->killer_index];
+
+        // Killer moves are quiet moves, the target square must be empty
+        if(BOARD_SQUARE_GET(POSITION_COVER_GET(*picker->position, SIDE_BOTH), PACKED_TARGET_GET(killer))) killer = PACKED_MOVE_NONE;
+
+        move = move_pickable_unpack(picker, killer);
+
+        // The killer is remembered, so it is not picked again with the quiet moves
+        picker->killers[picker->killer_index++] = move;
+
+        if(move != MOVE_NONE && move != picker->hash_move) return move;
+      }
+
+      picker->stage++;
+
+      // fall through
+
+    case PICK_STAGE_QUIETS_CREATE:
+      picker->moves.amount = 0;
+      picker->index = 0;
+
+      moves_quiets_create(&picker->moves, *picker->position, &picker->attack_map);
+
+      quiets_scores_guess(picker);
+
+      picker->stage++;
+
+      // fall through
+
+    case PICK_STAGE_QUIETS:
+      while((move = move_best_select(picker)) != MOVE_NONE)
+      {
+        if(!move_is_picked(picker, move)) return move;
+      }
+
+      picker->stage++;
+
+      // fall through
+
+    case PICK_STAGE_CAPTURES_BAD:
+      if(picker->bad_index < picker->bad_captures.amount)
+      {
+        return picker->bad_captures.moves[picker->bad_index++];
+      }
+
+      picker->stage++;
+
+      // fall through
+
+    case PICK_STAGE_DONE:
+      return MOVE_NONE;
+
+    case PICK_STAGE_EVASIONS_HASH:
+      picker->stage++;
+
+      if(picker->hash_move != MOVE_NONE) return picker->hash_move;
+
+      // fall through
+
+    case PICK_STAGE_EVASIONS_CREATE:
+      moves_evasions_create(&picker->moves, *picker->position, picker->checkers, &picker->attack_map);
+
+      evasions_scores_guess(picker);
+
+      picker->stage++;
+
+      // fall through
+
+    case PICK_STAGE_EVASIONS:
+      while((move = move_best_select(picker)) != MOVE_NONE)
+      {
+        if(move != picker->hash_move) return move;
+      }
+
+      picker->stage = PICK_STAGE_DONE;
+
+      return MOVE_NONE;
+
+    case PICK_STAGE_QUIESCENCE_CREATE:
+      moves_captures_create(&picker->moves, *picker->position, &picker->attack_map);
+
+      captures_scores_guess(picker);
+
+      picker->stage++;
+
+      // fall through
+
+    case PICK_STAGE_QUIESCENCE:
+      while((move = move_best_select(picker)) != MOVE_NONE)
+      {
+        // Bad captures are not worth searching in the quiescence search
+        if(!capture_is_bad(*picker->position, move)) return move;
+      }
+
+      picker->stage = PICK_STAGE_DONE;
+
+      // fall through
+
+    default:
+      return MOVE_NONE;
+  }
+}
@@ -3,13 +3,45 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-11
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
 
 #include "engine-intern.h"
 
+/*
+ * The kinds of moves to create
+ *
+ * Queen promotions count as captures,
+ * under promotions and castling count as quiet moves
+ */
+typedef enum
+{
+  MOVES_CAPTURES = 0b01,
+  MOVES_QUIETS   = 0b10,
+  MOVES_ALL      = MOVES_CAPTURES | MOVES_QUIETS
+} MovesKind;
+
+/*
+ * What the generator needs to know about the node,
+ * which is the same for every piece
+ *
+ * kind       | The kinds of moves to create
+ * targets    | The squares the pieces, except the king, are allowed to move to
+ * checkers   | The pieces that check the king
+ * pinned     | The own pieces that are pinned to the king
+ * attack_map | The squares attacked by the opponent
+ */
+typedef struct
+{
+  MovesKind  kind;
+  U64        targets;
+  U64        checkers;
+  U64        pinned;
+  AttackMap* attack_map;
+} MovesContext;
+
 /*
  * Add move to move array, but only if it is legal
  *
@@ -17,9 +49,9 @@
  * - true  | Move was added
  * - false | Move was not legal, and not added
  */
-static bool move_add_if_legal(MoveArray* move_array, Position position, Move move)
+static bool move_add_if_legal(MoveArray* move_array, Position position, Move move, const MovesContext* context)
 {
-  if(!engine_move_is_legal(position, move)) return false;
+  if(!move_is_legal_fast(&position, move, context->pinned, context->checkers)) return false;
 
   move_array->moves[move_array->amount++] = move;
 
@@ -27,370 +59,433 @@ static bool move_add_if_legal(MoveArray* move_array, Position position, Move mov
 }
 
 /*
- * Create the different promote moves for a white pawn
+ * The files and ranks that the pawn moves are shifted to and from
+ */
+#define BOARD_FILE_A 0x0101010101010101ULL
+#define BOARD_FILE_H 0x8080808080808080ULL
+
+#define BOARD_RANK_8 0x00000000000000ffULL
+#define BOARD_RANK_5 0x00000000ff000000ULL
+#define BOARD_RANK_4 0x000000ff00000000ULL
+#define BOARD_RANK_1 0xff00000000000000ULL
+
+/*
+ * Shift every square of the board by the offset,
+ * a negative offset shifts the squares towards A8
  */
-static void moves_white_pawn_promote_pieces_create(MoveArray* move_array, Move move)
+static U64 board_shift(U64 board, int offset)
 {
-  for(Piece piece = PIECE_WHITE_KNIGHT; piece <= PIECE_WHITE_QUEEN; piece++)
+  return (offset > 0) ? (board << offset) : (board >> -offset);
+}
+
+/*
+ * Create legal pawn moves to every target square,
+ * from the source square the offset behind the target square
+ */
+static void moves_pawn_targets_create(MoveArray* move_array, Position position, U64 targets, int offset, Piece pawn, Move flags, const MovesContext* context)
+{
+  while(targets)
   {
-    move = (move & ~MOVE_MASK_PROMOTE) | MOVE_PROMOTE_SET(piece);
+    Square target_square = board_first_square_pop(&targets);
+
+    Move move = MOVE_SOURCE_SET(target_square - offset) | MOVE_TARGET_SET(target_square) | MOVE_PIECE_SET(pawn) | flags;
 
-    move_array->moves[move_array->amount++] = move;
+    move_add_if_legal(move_array, position, move, context);
   }
 }
 
 /*
- * Create legal moves for a white pawn, which promotes
+ * Create legal promote moves to every target square,
+ * from the source square the offset behind the target square
  *
- * If a pawn is standing on A7, pawn_square - 9 will result in unsigned underflow
+ * The legality only has to be checked once for every target square,
+ * because the promote piece does not matter
  */
-static void moves_white_pawn_promote_create(MoveArray* move_array, Position position, Square pawn_square)
+static void moves_pawn_promotes_create(MoveArray* move_array, Position position, U64 targets, int offset, Piece pawn, Move flags, const MovesContext* context)
 {
-  Square left_square  = ((int) pawn_square - 9) > 0 ? (pawn_square - 9) : 0;
-  Square right_square = pawn_square - 7;
+  Side side = PIECE_SIDE_GET(pawn);
 
-  for(Square promote_square = left_square; promote_square <= right_square; promote_square++)
+  while(targets)
   {
-    Move move = move_promote_create(position, pawn_square, promote_square, PIECE_WHITE_PAWN, PIECE_WHITE_QUEEN);
+    Square target_square = board_first_square_pop(&targets);
+
+    Move move = MOVE_SOURCE_SET(target_square - offset) | MOVE_TARGET_SET(target_square) | MOVE_PIECE_SET(pawn) | flags;
+
+    Move queen_move = move | MOVE_PROMOTE_SET(PIECE_CREATE(PIECE_TYPE_QUEEN, side));
+
+    if(!move_is_legal_fast(&position, queen_move, context->pinned, context->checkers)) continue;
 
-    if(engine_move_is_legal(position, move))
+    for(PieceType type = PIECE_TYPE_KNIGHT; type <= PIECE_TYPE_QUEEN; type++)
     {
-      moves_white_pawn_promote_pieces_create(move_array, move);
+      MovesKind type_kind = (type == PIECE_TYPE_QUEEN) ? MOVES_CAPTURES : MOVES_QUIETS;
+
+      if(!(context->kind & type_kind)) continue;
+
+      move_array->moves[move_array->amount++] = move | MOVE_PROMOTE_SET(PIECE_CREATE(type, side));
     }
   }
 }
 
 /*
- * Create one of two capture moves for a white pawn
+ * Create legal moves for all the pawns of the side to move at once
  *
- * If no attacks exist, no capture move is created
+ * The pawn board is shifted forward to get the targets of every pawn,
+ * and every target square is then turned into a move
  */
-static void move_white_pawn_capture_create(MoveArray* move_array, Position position, Square pawn_square, U64* attacks)
+static void moves_pawns_create(MoveArray* move_array, Position position, const MovesContext* context)
 {
-  if(!(*attacks)) return;
+  MovesKind kind = context->kind;
 
-  Square target_square = board_first_square_get(*attacks);
+  U64 targets = context->targets;
 
+  Side side = position.side;
 
-  Move move = move_normal_create(position, pawn_square, target_square, PIECE_WHITE_PAWN);
+  Piece pawn = PIECE_CREATE(PIECE_TYPE_PAWN, side);
 
-  if(target_square == position.passant) move |= MOVE_MASK_PASSANT;
+  U64 pawns   = POSITION_BOARD_GET(position, pawn);
+  U64 empty   = ~POSITION_COVER_GET(position, SIDE_BOTH);
+  U64 enemies =  POSITION_COVER_GET(position, !side);
 
-  move_add_if_legal(move_array, position, move);
+  int forward = (side == SIDE_WHITE) ? -BOARD_FILES : BOARD_FILES;
 
+  U64 promote_rank = (side == SIDE_WHITE) ? BOARD_RANK_8 : BOARD_RANK_1;
+  U64 double_rank  = (side == SIDE_WHITE) ? BOARD_RANK_4 : BOARD_RANK_5;
 
-  *attacks = BOARD_SQUARE_POP(*attacks, target_square);
-}
+  U64 pushes  = board_shift(pawns, forward) & empty;
+  U64 doubles = board_shift(pushes, forward) & empty & double_rank & targets;
 
-/*
- * Create legal moves for a white pawn, that do not promote
- */
-static void moves_white_pawn_other_create(MoveArray* move_array, Position position, Square pawn_square)
-{
-  Move move = move_normal_create(position, pawn_square, pawn_square - BOARD_FILES, PIECE_WHITE_PAWN);
+  pushes &= targets;
 
-  move_add_if_legal(move_array, position, move);
+  // A pawn on the A file can not capture towards the A file, the same with the H file
+  U64 west_pawns = pawns & ~BOARD_FILE_A;
+  U64 east_pawns = pawns & ~BOARD_FILE_H;
 
-  // Get attack squares by looking up pawn attacks and
-  // checking if a black piece is there
-  U64 attacks = attacks_pawn_get(pawn_square, SIDE_WHITE);
+  U64 west_captures = board_shift(west_pawns, forward - 1) & enemies & targets;
+  U64 east_captures = board_shift(east_pawns, forward + 1) & enemies & targets;
 
-  // If the pawn is not on 5th rank,
-  // exclude all squares where there are no black pieces
-  if(!(pawn_square >= A5 && pawn_square <= H5))
+  moves_pawn_promotes_create(move_array, position, pushes        & promote_rank, forward,     pawn, MOVE_NONE,         context);
+  moves_pawn_promotes_create(move_array, position, west_captures & promote_rank, forward - 1, pawn, MOVE_MASK_CAPTURE, context);
+  moves_pawn_promotes_create(move_array, position, east_captures & promote_rank, forward + 1, pawn, MOVE_MASK_CAPTURE, context);
+
+  if(kind & MOVES_CAPTURES)
   {
-    attacks &= position.covers[SIDE_BLACK];
+    moves_pawn_targets_create(move_array, position, west_captures & ~promote_rank, forward - 1, pawn, MOVE_MASK_CAPTURE, context);
+    moves_pawn_targets_create(move_array, position, east_captures & ~promote_rank, forward + 1, pawn, MOVE_MASK_CAPTURE, context);
+
+    U64 passant = (position.passant != SQUARE_NONE) ? (1ULL << position.passant) : 0ULL;
+
+    // The captured pawn is behind the passant square, and can be one of the targets
+    if(passant & (targets | board_shift(targets, forward)))
+    {
+      moves_pawn_targets_create(move_array, position, board_shift(west_pawns, forward - 1) & passant, forward - 1, pawn, MOVE_MASK_PASSANT, context);
+      moves_pawn_targets_create(move_array, position, board_shift(east_pawns, forward + 1) & passant, forward + 1, pawn, MOVE_MASK_PASSANT, context);
+    }
   }
 
-  move_white_pawn_capture_create(move_array, position, pawn_square, &attacks);
+  if(kind & MOVES_QUIETS)
+  {
+    moves_pawn_targets_create(move_array, position, pushes & ~promote_rank, forward,     pawn, MOVE_NONE,        context);
+    moves_pawn_targets_create(move_array, position, doubles,                forward * 2, pawn, MOVE_MASK_DOUBLE, context);
+  }
+}
 
-  move_white_pawn_capture_create(move_array, position, pawn_square, &attacks);
+/*
+ * Create legal castling moves for the white king
+ *
+ * The king can not castle out of, through or into check,
+ * which the attacks of the opponent tell without making the move
+ */
+static void moves_white_castle_create(MoveArray* move_array, Position position, const MovesContext* context)
+{
+  if(!(context->kind & MOVES_QUIETS)) return;
 
+  U64 cover = POSITION_COVER_GET(position, SIDE_BOTH);
+  U64 rooks = POSITION_BOARD_GET(position, PIECE_WHITE_ROOK);
 
-  // If pawn is standing on 2nd rank, create double jump move
-  if(pawn_square >= A2 && pawn_square <= H2)
+  if((position.castle & CASTLE_WHITE_QUEEN) && BOARD_SQUARE_GET(rooks, A1) &&
+     !(cover & ((1ULL << B1) | (1ULL << C1) | (1ULL << D1))) &&
+     !(attack_map_get(context->attack_map, &position) & ((1ULL << C1) | (1ULL << D1) | (1ULL << E1))))
   {
-    Move move = move_double_create(pawn_square, pawn_square - (BOARD_FILES * 2), PIECE_WHITE_PAWN);
+    move_array->moves[move_array->amount++] = move_castle_create(E1, C1, PIECE_WHITE_KING);
+  }
 
-    move_add_if_legal(move_array, position, move);
+  if((position.castle & CASTLE_WHITE_KING) && BOARD_SQUARE_GET(rooks, H1) &&
+     !(cover & ((1ULL << F1) | (1ULL << G1))) &&
+     !(attack_map_get(context->attack_map, &position) & ((1ULL << E1) | (1ULL << F1) | (1ULL << G1))))
+  {
+    move_array->moves[move_array->amount++] = move_castle_create(E1, G1, PIECE_WHITE_KING);
   }
 }
 
 /*
- * Create legal moves for a white pawn
+ * Create legal castling moves for the black king
+ *
+ * The king can not castle out of, through or into check,
+ * which the attacks of the opponent tell without making the move
  */
-static void moves_white_pawn_create(MoveArray* move_array, Position position, Square pawn_square)
+static void moves_black_castle_create(MoveArray* move_array, Position position, const MovesContext* context)
 {
-  if(pawn_square >= A7 && pawn_square <= H7)
+  if(!(context->kind & MOVES_QUIETS)) return;
+
+  U64 cover = POSITION_COVER_GET(position, SIDE_BOTH);
+  U64 rooks = POSITION_BOARD_GET(position, PIECE_BLACK_ROOK);
+
+  if((position.castle & CASTLE_BLACK_QUEEN) && BOARD_SQUARE_GET(rooks, A8) &&
+     !(cover & ((1ULL << B8) | (1ULL << C8) | (1ULL << D8))) &&
+     !(attack_map_get(context->attack_map, &position) & ((1ULL << C8) | (1ULL << D8) | (1ULL << E8))))
   {
-    moves_white_pawn_promote_create(move_array, position, pawn_square);
+    move_array->moves[move_array->amount++] = move_castle_create(E8, C8, PIECE_BLACK_KING);
   }
-  else
+
+  if((position.castle & CASTLE_BLACK_KING) && BOARD_SQUARE_GET(rooks, H8) &&
+     !(cover & ((1ULL << F8) | (1ULL << G8))) &&
+     !(attack_map_get(context->attack_map, &position) & ((1ULL << E8) | (1ULL << F8) | (1ULL << G8))))
   {
-    moves_white_pawn_other_create(move_array, position, pawn_square);
+    move_array->moves[move_array->amount++] = move_castle_create(E8, G8, PIECE_BLACK_KING);
   }
 }
 
 /*
- * Create the different promote moves for a black pawn
+ * Get the squares that pieces, except pawns, can move to for the kind of moves
  */
-static void moves_black_pawn_promote_pieces_create(MoveArray* move_array, Move move)
+static U64 kind_targets_get(Position position, Side side, MovesKind kind)
 {
-  for(Piece piece = PIECE_BLACK_KNIGHT; piece <= PIECE_BLACK_QUEEN; piece++)
-  {
-    // Make this into a macro, or edit MOVE_PROMOTE_SET to implement this
-    move = (move & ~MOVE_MASK_PROMOTE) | MOVE_PROMOTE_SET(piece);
+  U64 targets = 0ULL;
 
-    move_array->moves[move_array->amount++] = move;
-  }
+  if(kind & MOVES_CAPTURES) targets |= POSITION_COVER_GET(position, !side);
+
+  if(kind & MOVES_QUIETS)   targets |= ~POSITION_COVER_GET(position, SIDE_BOTH);
+
+  return targets;
 }
 
 /*
- * Create legal moves for a black pawn, which promotes
- *
- * If a pawn is standing on H2, pawn_square + 9 will result in unsigned underflow
+ * Create legal moves for pieces, except pawns and the king
  */
-static void moves_black_pawn_promote_create(MoveArray* move_array, Position position, Square pawn_square)
+static void moves_normal_create(MoveArray* move_array, Position position, Square source_square, Piece piece, const MovesContext* context)
 {
-  Square right_square = ((int) pawn_square + 9) > 0 ? (pawn_square + 9) : 0;
-  Square left_square  = pawn_square + 7;
+  U64 attacks = attacks_get(source_square, position);
+
+  // Only keep the squares where the piece can move to,
+  // this also removes attacks on own pieces
+  attacks &= kind_targets_get(position, PIECE_SIDE_GET(piece), context->kind) & context->targets;
 
-  for(Square promote_square = left_square; promote_square <= right_square; promote_square++)
+  while(attacks)
   {
-    Move move = move_promote_create(position, pawn_square, promote_square, PIECE_BLACK_PAWN, PIECE_BLACK_QUEEN);
+    Square target_square = board_first_square_pop(&attacks);
 
-    if(engine_move_is_legal(position, move))
-    {
-      moves_black_pawn_promote_pieces_create(move_array, move);
-    }
+    Move move = move_normal_create(position, source_square, target_square, piece);
+    
+    move_add_if_legal(move_array, position, move, context);
   }
 }
 
 /*
- * Create one of two capture moves for a black pawn
+ * Create legal moves for the king
  *
- * If no attacks exist, no capture move is created
+ * The king can move to every square that the opponent does not attack,
+ * so no move has to be made to check if it is legal
  */
-static void move_black_pawn_capture_create(MoveArray* move_array, Position position, Square pawn_square, U64* attacks)
+static void moves_king_create(MoveArray* move_array, Position position, Square source_square, Piece piece, const MovesContext* context)
 {
-  if(!(*attacks)) return;
-
-  Square target_square = board_first_square_get(*attacks);
+  U64 attacks = attacks_king_get(source_square);
 
+  attacks &= kind_targets_get(position, PIECE_SIDE_GET(piece), context->kind);
 
-  Move move = move_normal_create(position, pawn_square, target_square, PIECE_BLACK_PAWN);
+  if(!attacks) return;
 
-  if(target_square == position.passant) move |= MOVE_MASK_PASSANT;
-
-  move_add_if_legal(move_array, position, move);
+  attacks &= ~attack_map_get(context->attack_map, &position);
 
+  while(attacks)
+  {
+    Square target_square = board_first_square_pop(&attacks);
 
-  *attacks = BOARD_SQUARE_POP(*attacks, target_square);
+    move_array->moves[move_array->amount++] = move_normal_create(position, source_square, target_square, piece);
+  }
 }
 
 /*
- * Create legal moves for a black pawn, that do not promote
+ * Create legal moves for white pieces, except pawns
  */
-static void moves_black_pawn_other_create(MoveArray* move_array, Position position, Square pawn_square)
+static void moves_white_normal_create(MoveArray* move_array, Position position, Square source_square, Piece piece, const MovesContext* context)
 {
-  Move move = move_normal_create(position, pawn_square, pawn_square + BOARD_FILES, PIECE_BLACK_PAWN);
-
-  move_add_if_legal(move_array, position, move);
-
-  // Get attack squares by looking up pawn attacks and
-  // checking if a black piece is there
-  U64 attacks = attacks_pawn_get(pawn_square, SIDE_BLACK);
-
-  // If the pawn is not on 4th rank,
-  // exclude all squares where there are no white pieces
-  if(!(pawn_square >= A4 && pawn_square <= H4))
+  if(piece != PIECE_WHITE_KING)
   {
-    attacks &= position.covers[SIDE_WHITE];
-  }
-
-  move_black_pawn_capture_create(move_array, position, pawn_square, &attacks);
+    moves_normal_create(move_array, position, source_square, piece, context);
 
-  move_black_pawn_capture_create(move_array, position, pawn_square, &attacks);
+    return;
+  }
 
+  moves_king_create(move_array, position, source_square, piece, context);
 
-  // If pawn is standing on 7th rank, create double jump move
-  if(pawn_square >= A7 && pawn_square <= H7)
+  if(source_square == E1)
   {
-    Move move = move_double_create(pawn_square, pawn_square + (BOARD_FILES * 2), PIECE_BLACK_PAWN);
-
-    move_add_if_legal(move_array, position, move);
+    moves_white_castle_create(move_array, position, context);
   }
 }
 
 /*
- * Create legal moves for a black pawn
+ * Create legal moves for white, except pawns
  */
-static void moves_black_pawn_create(MoveArray* move_array, Position position, Square pawn_square)
+static void moves_white_create(MoveArray* move_array, Position position, const MovesContext* context)
 {
-  if(pawn_square >= A2 && pawn_square <= H2)
+  for(Piece piece = PIECE_WHITE_KNIGHT; piece <= PIECE_WHITE_KING; piece++)
   {
-    moves_black_pawn_promote_create(move_array, position, pawn_square);
-  }
-  else
-  {
-    moves_black_pawn_other_create(move_array, position, pawn_square);
+    U64 piece_board = POSITION_BOARD_GET(position, piece);
+
+    while(piece_board)
+    {
+      Square source_square = board_first_square_pop(&piece_board);
+
+      moves_white_normal_create(move_array, position, source_square, piece, context);
+    }
   }
 }
 
 /*
- * Create legal castling move for the white king
+ * Create legal moves for black pieces, except pawns
  */
-static void moves_white_castle_create(MoveArray* move_array, Position position)
+static void moves_black_normal_create(MoveArray* move_array, Position position, Square source_square, Piece piece, const MovesContext* context)
 {
-  if(position.castle & CASTLE_WHITE_QUEEN)
+  if(piece != PIECE_BLACK_KING)
   {
-    Move move = move_castle_create(E1, C1, PIECE_WHITE_KING);
+    moves_normal_create(move_array, position, source_square, piece, context);
 
-    move_add_if_legal(move_array, position, move);
+    return;
   }
 
-  if(position.castle & CASTLE_WHITE_KING)
-  {
-    Move move = move_castle_create(E1, G1, PIECE_WHITE_KING);
+  moves_king_create(move_array, position, source_square, piece, context);
 
-    move_add_if_legal(move_array, position, move);
+  if(source_square == E8)
+  {
+    moves_black_castle_create(move_array, position, context);
   }
 }
 
 /*
- * Create legal castling move for the black king
+ * Create legal moves for black, except pawns
  */
-static void moves_black_castle_create(MoveArray* move_array, Position position)
+static void moves_black_create(MoveArray* move_array, Position position, const MovesContext* context)
 {
-  if(position.castle & CASTLE_BLACK_QUEEN)
+  for(Piece piece = PIECE_BLACK_KNIGHT; piece <= PIECE_BLACK_KING; piece++)
   {
-    Move move = move_castle_create(E8, C8, PIECE_BLACK_KING);
+    U64 piece_board = POSITION_BOARD_GET(position, piece);
 
-    move_add_if_legal(move_array, position, move);
-  }
-  
-  if(position.castle & CASTLE_BLACK_KING)
-  {
-    Move move = move_castle_create(E8, G8, PIECE_BLACK_KING);
+    while(piece_board)
+    {
+      Square source_square = board_first_square_pop(&piece_board);
 
-    move_add_if_legal(move_array, position, move);
+      moves_black_normal_create(move_array, position, source_square, piece, context);
+    }
   }
 }
 
 /*
- * Create legal moves for pieces, except pawns
+ * Get the squares attacked by the opponent, and create them if needed
+ *
+ * RETURN (U64 board)
  */
-static void moves_normal_create(MoveArray* move_array, Position position, Square source_square, Piece piece)
+U64 attack_map_get(AttackMap* attack_map, const Position* position)
 {
-  U64 attacks = attacks_get(source_square, position);
-
-  // Remove attacks on own pieces, by
-  // only keeping the squares where no own piece are
-  attacks &= ~(position.covers[PIECE_SIDE_GET(piece)]);
-
-  while(attacks)
+  if(!attack_map->created)
   {
-    Square target_square = board_first_square_get(attacks);
+    U64 king  = position->types[PIECE_TYPE_KING] & position->sides[position->side];
 
-    Move move = move_normal_create(position, source_square, target_square, piece);
-    
-    move_add_if_legal(move_array, position, move);
+    U64 cover = POSITION_COVER_GET(*position, SIDE_BOTH) & ~king;
 
-    attacks = BOARD_SQUARE_POP(attacks, target_square);
+    attack_map->board   = side_attacks_get(position, !position->side, cover);
+    attack_map->created = true;
   }
+
+  return attack_map->board;
 }
 
 /*
- * Create legal moves for white pieces, except pawns
+ * Get the squares that a piece, except the king, can move to,
+ * to get the king out of check
+ *
+ * The piece can capture the checking piece, or move in between it and the king.
+ * If more than one piece checks the king, only the king can move
  */
-static void moves_white_normal_create(MoveArray* move_array, Position position, Square source_square, Piece piece)
+static U64 evasion_targets_get(Position position, U64 checkers)
 {
-  moves_normal_create(move_array, position, source_square, piece);
+  if(board_bit_amount_get(checkers) != 1) return 0ULL;
 
-  if(piece == PIECE_WHITE_KING && source_square == E1)
-  {
-    moves_white_castle_create(move_array, position);
-  }
+  Piece king = PIECE_CREATE(PIECE_TYPE_KING, position.side);
+
+  Square king_square    = board_first_square_get(POSITION_BOARD_GET(position, king));
+  Square checker_square = board_first_square_get(checkers);
+
+  return checkers | BOARD_LINES[king_square][checker_square];
 }
 
 /*
- * Create legal moves for white
+ * Create legal moves of the supplied kind for the specified position
+ *
+ * If the king is in check, only the moves that get the king out of check are created
+ *
+ * PARAMS
+ * - U64 checkers | The pieces that check the king of the side to move
  */
-static void moves_white_create(MoveArray* move_array, Position position)
+static void moves_kind_create(MoveArray* move_array, Position position, MovesKind kind, U64 checkers, AttackMap* attack_map)
 {
-  for(Piece piece = PIECE_WHITE_PAWN; piece <= PIECE_WHITE_KING; piece++)
+  MovesContext context =
   {
-    U64 piece_board = position.boards[piece];
+    .kind       = kind,
+    .targets    = checkers ? evasion_targets_get(position, checkers) : ~0ULL,
+    .checkers   = checkers,
+    .pinned     = position_pinned_get(&position),
+    .attack_map = attack_map
+  };
 
-    while(piece_board)
-    {
-      Square source_square = board_first_square_get(piece_board);
-
-      if(piece == PIECE_WHITE_PAWN)
-      {
-        moves_white_pawn_create(move_array, position, source_square);
-      }
-      else
-      {
-        moves_white_normal_create(move_array, position, source_square, piece);
-      }
-
-      piece_board = BOARD_SQUARE_POP(piece_board, source_square);
-    }
+  moves_pawns_create(move_array, position, &context);
+
+  if(position.side == SIDE_WHITE)
+  {
+    moves_white_create(move_array, position, &context);
+  }
+  else
+  {
+    moves_black_create(move_array, position, &context);
   }
 }
 
 /*
- * Create legal moves for black pieces, except pawns
+ * Create legal moves for the specified position
  */
-static void moves_black_normal_create(MoveArray* move_array, Position position, Square source_square, Piece piece)
+void moves_create(MoveArray* move_array, Position position)
 {
-  moves_normal_create(move_array, position, source_square, piece);
+  AttackMap attack_map = { .created = false };
 
-  if(piece == PIECE_BLACK_KING && source_square == E8)
-  {
-    moves_black_castle_create(move_array, position);
-  }
+  moves_kind_create(move_array, position, MOVES_ALL, position_checkers_get(&position), &attack_map);
 }
 
 /*
- * Create legal moves for black
+ * Create legal captures and queen promotions for the specified position
  */
-static void moves_black_create(MoveArray* move_array, Position position)
+void moves_captures_create(MoveArray* move_array, Position position, AttackMap* attack_map)
 {
-  for(Piece piece = PIECE_BLACK_PAWN; piece <= PIECE_BLACK_KING; piece++)
-  {
-    U64 piece_board = position.boards[piece];
+  moves_kind_create(move_array, position, MOVES_CAPTURES, position_checkers_get(&position), attack_map);
+}
 
-    while(piece_board)
-    {
-      Square source_square = board_first_square_get(piece_board);
-
-      if(piece == PIECE_BLACK_PAWN)
-      {
-        moves_black_pawn_create(move_array, position, source_square);
-      }
-      else
-      {
-        moves_black_normal_create(move_array, position, source_square, piece);
-      }
-
-      piece_board = BOARD_SQUARE_POP(piece_board, source_square);
-    }
-  }
+/*
+ * Create legal quiet moves and under promotions for the specified position
+ */
+void moves_quiets_create(MoveArray* move_array, Position position, AttackMap* attack_map)
+{
+  moves_kind_create(move_array, position, MOVES_QUIETS, position_checkers_get(&position), attack_map);
 }
 
 /*
- * Create legal moves for the specified position
+ * Create legal moves that get the king out of check
+ *
+ * The king can move away from the check, and the other pieces can
+ * capture the checking piece or move in between it and the king
+ *
+ * PARAMS
+ * - U64 checkers | The pieces that check the king of the side to move
  */
-void moves_create(MoveArray* move_array, Position position)
+void moves_evasions_create(MoveArray* move_array, Position position, U64 checkers, AttackMap* attack_map)
 {
-  if(position.side == SIDE_WHITE)
-  {
-    moves_white_create(move_array, position);
-  }
-  else
-  {
-    moves_black_create(move_array, position);
-  }
+  moves_kind_create(move_array, position, MOVES_ALL, checkers, attack_map);
 }
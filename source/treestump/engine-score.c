@@ -3,7 +3,7 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
@@ -127,7 +127,8 @@ int square_score_get(Piece piece, Square square)
 }
 
 /*
- * Get the score assosiated with a specific piece
+ * Get the score assosiated with a specific piece,
+ * from the view of white, like the square scores
  */
 static int piece_score_get(Piece piece)
 {
@@ -137,7 +138,7 @@ static int piece_score_get(Piece piece)
   }
   else if(piece >= PIECE_BLACK_PAWN && piece <= PIECE_BLACK_KING)
   {
-    return PIECE_SCORES[piece - PIECE_BLACK_PAWN];
+    return -PIECE_SCORES[piece - PIECE_BLACK_PAWN];
   }
   else return 0;
 }
@@ -146,22 +147,20 @@ static int piece_score_get(Piece piece)
  * Get the score of the board,
  * based on what pieces are at what squares
  */
-static int board_score_get(U64 boards[12])
+static int board_score_get(Position position)
 {
   int boardScore = 0;
 
   for(Piece piece = PIECE_WHITE_PAWN; piece <= PIECE_BLACK_KING; piece++)
   {
-    U64 bitboard = boards[piece];
+    U64 bitboard = POSITION_BOARD_GET(position, piece);
 
     while(bitboard)
     {
-      Square square = board_first_square_get(bitboard);
+      Square square = board_first_square_pop(&bitboard);
 
       boardScore += piece_score_get(piece);
       boardScore += square_score_get(piece, square);
-
-      bitboard = BOARD_SQUARE_POP(bitboard, square);
     }
   }
 
@@ -175,7 +174,7 @@ int position_score_get(Position position)
 {
   int positionScore = 0;
 
-  positionScore += board_score_get(position.boards);
+  positionScore += board_score_get(position);
   
   return positionScore;
 }
@@ -0,0 +1,507 @@
+/*
+ * Play two search configurations against each other in this process
+ *
+ * Both configurations are the same engine, and only differ by the
+ * search limits of every move, like node or time odds
+ *
+ * The games are played by several threads, every thread with its own
+ * search state and a hash table per side. Every opening is played twice,
+ * with the configurations swapping sides, and the match stops early
+ * when the sequential probability ratio test accepts a hypothesis
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "engine-intern.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define SELFPLAY_HASH_SIZE 16
+
+// The prior results of the test, and the closest score to 0 and 1 of the report
+#define SELFPLAY_PRIOR_GAMES   0.5
+#define SELFPLAY_SCORE_EPSILON 0.001
+
+// Both sides agree that one side is winning, for a number of plies
+#define SELFPLAY_RESIGN_SCORE 1000
+#define SELFPLAY_RESIGN_PLIES 6
+
+// Both sides agree that the game is even, after the opening
+#define SELFPLAY_DRAW_SCORE 10
+#define SELFPLAY_DRAW_PLIES 12
+#define SELFPLAY_DRAW_START 80
+
+// The error rates of the test, both 5%
+#define SPRT_ALPHA 0.05
+#define SPRT_BETA  0.05
+
+/*
+ * The state that the playing threads share
+ *
+ * next    | The next game to play, taken atomically
+ * stopped | The test has accepted a hypothesis, so no more games are started
+ * wins    | The results are counted for the first configuration,
+ *           and are guarded by the mutex
+ */
+typedef struct
+{
+  const Position*     openings;
+  size_t              amount;
+  const SearchLimits* limits;
+  int                 games;
+  int                 next;
+  bool                stopped;
+  int                 wins;
+  int                 losses;
+  int                 draws;
+  double              elo0;
+  double              elo1;
+  FILE*               file;
+  pthread_mutex_t     mutex;
+} Selfplay;
+
+/*
+ * The expected score of a side that is stronger by the elo
+ */
+static double elo_score_get(double elo)
+{
+  return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+/*
+ * The elo difference that gives the expected score
+ */
+static double score_elo_get(double score)
+{
+  if(score <= 0.0) return -INFINITY;
+
+  if(score >= 1.0) return INFINITY;
+
+  return -400.0 * log10(1.0 / score - 1.0);
+}
+
+/*
+ * Get the mean score and its variance per game, of the first configuration
+ *
+ * Half a win and half a loss are added to the results, so that the variance
+ * is above zero, even when every game has the same result
+ */
+static void selfplay_score_get(const Selfplay* selfplay, double* score, double* variance)
+{
+  double games = selfplay->wins + selfplay->losses + selfplay->draws + 2.0 * SELFPLAY_PRIOR_GAMES;
+
+  double wins  = (selfplay->wins + SELFPLAY_PRIOR_GAMES) / games;
+  double draws = selfplay->draws / games;
+
+  *score = wins + draws / 2.0;
+
+  *variance = wins + draws / 4.0 - (*score * *score);
+}
+
+/*
+ * Get the log likelihood ratio of elo1 against elo0,
+ * by the normal approximation of the game results
+ */
+static double selfplay_llr_get(const Selfplay* selfplay)
+{
+  int games = selfplay->wins + selfplay->losses + selfplay->draws;
+
+  if(games == 0) return 0.0;
+
+  double score, variance;
+
+  selfplay_score_get(selfplay, &score, &variance);
+
+  double score0 = elo_score_get(selfplay->elo0);
+  double score1 = elo_score_get(selfplay->elo1);
+
+  return (score1 - score0) * (2.0 * score - score0 - score1) * games / (2.0 * variance);
+}
+
+/*
+ * Write the results so far, with the elo and its 95% error margin
+ */
+static void selfplay_results_write(const Selfplay* selfplay)
+{
+  int games = selfplay->wins + selfplay->losses + selfplay->draws;
+
+  double score, variance;
+
+  selfplay_score_get(selfplay, &score, &variance);
+
+  double margin = 1.96 * sqrt(variance / games);
+
+  double elo = score_elo_get(score);
+
+  // The scores of the margin are kept inside (0, 1), where the elo is finite
+  double upperScore = fmin(score + margin, 1.0 - SELFPLAY_SCORE_EPSILON);
+  double lowerScore = fmax(score - margin, SELFPLAY_SCORE_EPSILON);
+
+  double eloMargin = (score_elo_get(upperScore) - score_elo_get(lowerScore)) / 2.0;
+
+  double lowerBound = log(SPRT_BETA / (1.0 - SPRT_ALPHA));
+  double upperBound = log((1.0 - SPRT_BETA) / SPRT_ALPHA);
+
+  fprintf(selfplay->file, "Games %d: W %d L %d D %d, Elo %.1f +- %.1f, LLR %.2f (%.2f, %.2f)\n",
+    games, selfplay->wins, selfplay->losses, selfplay->draws, elo, eloMargin,
+    selfplay_llr_get(selfplay), lowerBound, upperBound);
+}
+
+/*
+ * Count the result of a game, and stop the match if the test is decided
+ *
+ * PARAMS
+ * - PackedResult result | The result from the view of the first configuration,
+ *                         where PACKED_RESULT_WHITE is a win
+ */
+static void selfplay_result_store(Selfplay* selfplay, PackedResult result)
+{
+  pthread_mutex_lock(&selfplay->mutex);
+
+  if(result == PACKED_RESULT_WHITE) selfplay->wins++;
+
+  else if(result == PACKED_RESULT_BLACK) selfplay->losses++;
+
+  else selfplay->draws++;
+
+  selfplay_results_write(selfplay);
+
+  double llr = selfplay_llr_get(selfplay);
+
+  if(llr <= log(SPRT_BETA / (1.0 - SPRT_ALPHA)) || llr >= log((1.0 - SPRT_BETA) / SPRT_ALPHA))
+  {
+    __atomic_store_n(&selfplay->stopped, true, __ATOMIC_RELAXED);
+  }
+
+  fflush(selfplay->file);
+
+  pthread_mutex_unlock(&selfplay->mutex);
+}
+
+/*
+ * Check if neither side has enough pieces to mate,
+ * which is when there only is one knight or bishop left
+ */
+static bool position_material_is_insufficient(Position position)
+{
+  U64 heavy = position.types[PIECE_TYPE_PAWN] | position.types[PIECE_TYPE_ROOK] | position.types[PIECE_TYPE_QUEEN];
+
+  if(heavy) return false;
+
+  U64 minor = position.types[PIECE_TYPE_KNIGHT] | position.types[PIECE_TYPE_BISHOP];
+
+  return board_bit_amount_get(minor) <= 1;
+}
+
+/*
+ * Check if the position has been in the game two times before
+ */
+static bool position_is_repeated(const KeyHistory* history, Position position)
+{
+  U64 hashKey = create_hash_key(position);
+
+  int repetitions = 0;
+
+  for(int index = history->amount - 2; index >= 0; index -= 2)
+  {
+    if(history->keys[index] == hashKey) repetitions++;
+  }
+
+  return (repetitions >= 2);
+}
+
+/*
+ * Check if the position and its best move are quiet,
+ * so that the score of the search is the score of the position
+ */
+static bool position_is_quiet(Position position, Move move, int score)
+{
+  if(position_checkers_get(&position)) return false;
+
+  if(move & (MOVE_MASK_CAPTURE | MOVE_MASK_PASSANT)) return false;
+
+  if(MOVE_PROMOTE_GET(move) != PIECE_WHITE_PAWN) return false;
+
+  return (abs(score) < SCORE_MATE - SEARCH_MAX_PLY);
+}
+
+/*
+ * Play a game from the opening, and get the result for white
+ *
+ * The quiet positions of the game can be recorded with their scores,
+ * the caller sets their result when the game is over
+ *
+ * PARAMS
+ * - HashTable          tables[2]     | The hash tables of the configurations
+ * - const SearchLimits limits[2]     | The limits of the configurations
+ * - int                firstEngine   | The configuration that moves first in the opening
+ * - PackedPosition*    packeds       | Room for SELFPLAY_MAX_PLIES positions, or NULL
+ * - int*               packed_amount | The amount of recorded positions
+ */
+PackedResult selfplay_game_play(Search* search, HashTable tables[2], const SearchLimits limits[2], Position position, int firstEngine, PackedPosition* packeds, int* packed_amount)
+{
+  if(packed_amount) *packed_amount = 0;
+
+  KeyHistory history;
+
+  key_history_clear(&history);
+
+  hash_table_clear(&tables[0]);
+  hash_table_clear(&tables[1]);
+
+  int resignPlies = 0;
+  int drawPlies   = 0;
+
+  for(int ply = 0; ply < SELFPLAY_MAX_PLIES; ply++)
+  {
+    if(position.clock >= 100 || position_is_repeated(&history, position) ||
+       position_material_is_insufficient(position))
+    {
+      return PACKED_RESULT_DRAW;
+    }
+
+    int engine = (ply % 2 == 0) ? firstEngine : !firstEngine;
+
+    memset(search, 0, sizeof(Search));
+
+    search->table  = &tables[engine];
+    search->limits = &limits[engine];
+
+    memcpy(search->keys, history.keys, history.amount * sizeof(U64));
+
+    search->key_amount = history.amount;
+
+    Move move = best_move_search(search, position);
+
+    if(move == MOVE_NONE)
+    {
+      if(!position_checkers_get(&position)) return PACKED_RESULT_DRAW;
+
+      return (position.side == SIDE_WHITE) ? PACKED_RESULT_BLACK : PACKED_RESULT_WHITE;
+    }
+
+    int whiteScore = (position.side == SIDE_WHITE) ? search->score : -search->score;
+
+    if(packeds && position_is_quiet(position, move, search->score) &&
+       position_pack(&packeds[*packed_amount], position) == 0)
+    {
+      int packedScore = (whiteScore > 32000) ? 32000 : (whiteScore < -32000) ? -32000 : whiteScore;
+
+      packeds[(*packed_amount)++].score = packedScore;
+    }
+
+    // The winning side must stay the same, for the plies to be counted
+    if(whiteScore >= SELFPLAY_RESIGN_SCORE)
+    {
+      resignPlies = (resignPlies > 0) ? (resignPlies + 1) : 1;
+    }
+    else if(whiteScore <= -SELFPLAY_RESIGN_SCORE)
+    {
+      resignPlies = (resignPlies < 0) ? (resignPlies - 1) : -1;
+    }
+    else resignPlies = 0;
+
+    if(resignPlies >=  SELFPLAY_RESIGN_PLIES) return PACKED_RESULT_WHITE;
+
+    if(resignPlies <= -SELFPLAY_RESIGN_PLIES) return PACKED_RESULT_BLACK;
+
+    drawPlies = (ply >= SELFPLAY_DRAW_START && abs(whiteScore) <= SELFPLAY_DRAW_SCORE) ? (drawPlies + 1) : 0;
+
+    if(drawPlies >= SELFPLAY_DRAW_PLIES) return PACKED_RESULT_DRAW;
+
+    key_history_push(&history, position);
+
+    move_make(&position, move);
+
+    if(position.clock == 0) key_history_clear(&history);
+  }
+
+  return PACKED_RESULT_DRAW;
+}
+
+/*
+ * Remove the openings without legal moves, that have no game to play
+ *
+ * RETURN (size_t amount)
+ * - The amount of playable openings
+ */
+static size_t selfplay_openings_filter(Position* openings, size_t amount)
+{
+  size_t playable = 0;
+
+  for(size_t index = 0; index < amount; index++)
+  {
+    MoveArray moveArray;
+    moveArray.amount = 0;
+
+    moves_create(&moveArray, openings[index]);
+
+    if(moveArray.amount > 0) openings[playable++] = openings[index];
+  }
+
+  if(args.debug && playable < amount)
+  {
+    error_print("Skipped %ld openings without legal moves", (long) (amount - playable));
+  }
+
+  return playable;
+}
+
+/*
+ * Play the next game, until every game is played or the test is decided
+ *
+ * Game 2n and 2n+1 are played from the same opening,
+ * with the first configuration moving first in game 2n
+ */
+static void* selfplay_thread_run(void* data)
+{
+  Selfplay* selfplay = data;
+
+  HashTable tables[2] =
+  {
+    { .entries = NULL, .amount = 0 },
+    { .entries = NULL, .amount = 0 }
+  };
+
+  // Without hash tables, the search still works, only slower
+  hash_table_init(&tables[0], SELFPLAY_HASH_SIZE);
+  hash_table_init(&tables[1], SELFPLAY_HASH_SIZE);
+
+  Search* search = malloc(sizeof(Search));
+
+  int game;
+
+  while(search && !__atomic_load_n(&selfplay->stopped, __ATOMIC_RELAXED) &&
+        (game = __atomic_fetch_add(&selfplay->next, 1, __ATOMIC_RELAXED)) < selfplay->games)
+  {
+    Position opening = selfplay->openings[(game / 2) % selfplay->amount];
+
+    int firstEngine = game % 2;
+
+    PackedResult result = selfplay_game_play(search, tables, selfplay->limits, opening, firstEngine, NULL, NULL);
+
+    // The result for the side of the first configuration
+    Side firstSide = (firstEngine == 0) ? opening.side : !opening.side;
+
+    if(result != PACKED_RESULT_DRAW && firstSide == SIDE_BLACK)
+    {
+      result = (result == PACKED_RESULT_WHITE) ? PACKED_RESULT_BLACK : PACKED_RESULT_WHITE;
+    }
+
+    selfplay_result_store(selfplay, result);
+  }
+
+  if(search) free(search);
+
+  hash_table_free(&tables[0]);
+  hash_table_free(&tables[1]);
+
+  return NULL;
+}
+
+/*
+ * Play a match between two search configurations
+ *
+ * PARAMS
+ * - const char*         openings      | File with one fen or epd per line
+ * - const char*         output        | File to write the results to, or NULL for stdout
+ * - const SearchLimits  limits[2]     | The limits of every move of the configurations
+ * - int                 games         | The most games to play
+ * - int                 thread_amount | Threads to play with, or 0 for every processor
+ * - double              elo0, elo1    | The elo bounds of the test
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to load the openings
+ * - 2 | Failed to open the output file
+ */
+int selfplay_match(const char* openings, const char* output, const SearchLimits limits[2], int games, int thread_amount, double elo0, double elo1)
+{
+  size_t amount = 0;
+
+  Position* positions = fens_file_load(openings, &amount, NULL, thread_amount);
+
+  if(positions) amount = selfplay_openings_filter(positions, amount);
+
+  if(!positions || amount == 0)
+  {
+    if(args.debug) error_print("Failed to load openings: %s", openings);
+
+    if(positions) free(positions);
+
+    return 1;
+  }
+
+  FILE* file = output ? fopen(output, "w") : stdout;
+
+  if(!file)
+  {
+    if(args.debug) error_print("Failed to open output: %s", output);
+
+    free(positions);
+
+    return 2;
+  }
+
+  Selfplay selfplay =
+  {
+    .openings = positions,
+    .amount   = amount,
+    .limits   = limits,
+    .games    = games,
+    .next     = 0,
+    .stopped  = false,
+    .wins     = 0,
+    .losses   = 0,
+    .draws    = 0,
+    .elo0     = elo0,
+    .elo1     = elo1,
+    .file     = file,
+    .mutex    = PTHREAD_MUTEX_INITIALIZER
+  };
+
+  if(thread_amount <= 0) thread_amount = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if(thread_amount <= 0) thread_amount = 1;
+
+  pthread_t threads[thread_amount];
+
+  int threadCount = 0;
+
+  for(; threadCount < thread_amount; threadCount++)
+  {
+    if(pthread_create(&threads[threadCount], NULL, selfplay_thread_run, &selfplay) != 0) break;
+  }
+
+  // The games are played by this thread, if no thread could be created
+  if(threadCount == 0) selfplay_thread_run(&selfplay);
+
+  for(int index = 0; index < threadCount; index++)
+  {
+    pthread_join(threads[index], NULL);
+  }
+
+  double llr = selfplay_llr_get(&selfplay);
+
+  if(llr >= log((1.0 - SPRT_BETA) / SPRT_ALPHA))
+  {
+    fprintf(file, "SPRT: H1 accepted, elo >= %.1f\n", elo1);
+  }
+  else if(llr <= log(SPRT_BETA / (1.0 - SPRT_ALPHA)))
+  {
+    fprintf(file, "SPRT: H0 accepted, elo <= %.1f\n", elo0);
+  }
+  else fprintf(file, "SPRT: no decision\n");
+
+  if(file != stdout) fclose(file);
+
+  free(positions);
+
+  return 0;
+}
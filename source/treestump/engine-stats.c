@@ -0,0 +1,59 @@
+/*
+ * Print the statistics of a search, when built with SEARCH_STATS
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "engine-intern.h"
+
+#ifdef SEARCH_STATS
+
+/*
+ * Get the part of the total in percent, or zero without a total
+ */
+static double stats_percent_get(U64 part, U64 total)
+{
+  return (total > 0) ? (100.0 * part / total) : 0.0;
+}
+
+/*
+ * Print the statistics of the search as info string lines
+ *
+ * The effective branching factor of a depth is how many times
+ * more nodes it took than the depth before it
+ */
+void search_stats_print(const Search* search)
+{
+  const SearchStats* stats = &search->stats;
+
+  printf("info string stats nodes %llu qnodes %llu (%.1f%%)\n",
+    search->nodes, stats->qnodes, stats_percent_get(stats->qnodes, search->nodes));
+
+  printf("info string stats cutoffs %llu first move %.1f%%\n",
+    stats->cutoffs, stats_percent_get(stats->first_cutoffs, stats->cutoffs));
+
+  printf("info string stats hash probes %llu hits %.1f%% cutoffs %.1f%%\n",
+    stats->hash_probes, stats_percent_get(stats->hash_hits, stats->hash_probes),
+    stats_percent_get(stats->hash_cutoffs, stats->hash_probes));
+
+  U64 lastNodes = 0;
+
+  for(int depth = 1; depth <= stats->depth; depth++)
+  {
+    U64 depthNodes = stats->depth_nodes[depth] - stats->depth_nodes[depth - 1];
+
+    double branching = (lastNodes > 0) ? ((double) depthNodes / lastNodes) : 0.0;
+
+    printf("info string stats depth %d nodes %llu ebf %.2f\n", depth, depthNodes, branching);
+
+    lastNodes = depthNodes;
+  }
+
+  fflush(stdout);
+}
+
+#endif // SEARCH_STATS
@@ -1,98 +1,565 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
 
 #include "engine-intern.h"
 
-U64 searchedNodes = 0;
+/*
+ * Remember a quiet move that caused a beta cutoff,
+ * so it can be picked early in sibling nodes
+ */
+static void quiet_move_cutoff_store(Search* search, Move move, int depth, int ply)
+{
+  if(move & (MOVE_MASK_CAPTURE | MOVE_MASK_PASSANT | MOVE_MASK_PROMOTE)) return;
+
+  PackedMove killer = move_pack(move);
+
+  if(search->killers[ply][0] != killer)
+  {
+    search->killers[ply][1] = search->killers[ply][0];
+    search->killers[ply][0] = killer;
+  }
+
+  search->history[MOVE_PIECE_GET(move)][MOVE_TARGET_GET(move)] += (depth * depth);
+}
+
+/*
+ * Check if the score of an entry is enough to return it, without searching
+ */
+static bool hash_entry_score_cuts(HashEntry* entry, int score, int alpha, int beta)
+{
+  switch(entry->flag)
+  {
+    case HASH_FLAG_EXACT:
+      return true;
+
+    case HASH_FLAG_ALPHA:
+      return (score <= alpha);
+
+    case HASH_FLAG_BETA:
+      return (score >= beta);
+
+    default:
+      return false;
+  }
+}
+
+/*
+ * Get the score to store in the hash table
+ *
+ * A mate score is stored as the plies to mate from the node,
+ * instead of from the root, so it can be used at another ply
+ */
+static int hash_score_store_get(int score, int ply)
+{
+  if(score >= SCORE_MATE - SEARCH_MAX_PLY)  return score + ply;
+
+  if(score <= -SCORE_MATE + SEARCH_MAX_PLY) return score - ply;
+
+  return score;
+}
+
+/*
+ * Get the score of a hash entry, at the ply of the node
+ */
+static int hash_score_load_get(int score, int ply)
+{
+  if(score >= SCORE_MATE - SEARCH_MAX_PLY)  return score - ply;
+
+  if(score <= -SCORE_MATE + SEARCH_MAX_PLY) return score + ply;
+
+  return score;
+}
+
+/*
+ * Get what kind of score the search of a node resulted in
+ */
+static HashFlag hash_flag_get(int score, int alpha, int beta)
+{
+  if(score <= alpha) return HASH_FLAG_ALPHA;
+
+  if(score >= beta)  return HASH_FLAG_BETA;
+
+  return HASH_FLAG_EXACT;
+}
+
+/*
+ * Get the score of the position, from the view of the side to move
+ */
+static int position_side_score_get(Position position)
+{
+  int score = position_score_get(position);
+
+  return (position.side == SIDE_WHITE) ? score : -score;
+}
+
+/*
+ * Get the current time in milliseconds
+ */
+long time_ms_get(void)
+{
+  struct timespec timespec;
+
+  clock_gettime(CLOCK_MONOTONIC, &timespec);
+
+  return (timespec.tv_sec * 1000) + (timespec.tv_nsec / 1000000);
+}
+
+/*
+ * Check if the search has to stop, because it was told to stop,
+ * or because it has searched its nodes or used its time
+ *
+ * The clock is only read every 1024 nodes, and not while pondering
+ */
+bool search_is_stopped(Search* search)
+{
+  if(search->stopped) return true;
+
+  const SearchLimits* limits = search->limits;
+
+  if(__atomic_load_n(&limits->stop, __ATOMIC_RELAXED))
+  {
+    search->stopped = true;
+  }
+  else if(limits->nodes >= 0 && search->nodes >= limits->nodes)
+  {
+    search->stopped = true;
+  }
+  else if(search->time_limit >= 0 && (search->nodes & 1023) == 0 &&
+    !__atomic_load_n(&limits->ponder, __ATOMIC_RELAXED))
+  {
+    search->stopped = (time_ms_get() - search->start_time) >= search->time_limit;
+  }
+
+  return search->stopped;
+}
+
+/*
+ * Store the move as the start of the principal variation of the ply,
+ * followed by the principal variation of the ply after it
+ */
+static void pv_store(Search* search, int ply, Move move)
+{
+  int length = search->pv_lengths[ply + 1];
+
+  search->pv[ply][0] = move_pack(move);
+
+  memcpy(&search->pv[ply][1], search->pv[ply + 1], length * sizeof(PackedMove));
+
+  search->pv_lengths[ply] = length + 1;
+}
 
 /*
+ * Search only the captures, until the position is quiet
  *
+ * The side to move can stand pat, and not capture,
+ * unless the king is in check, then every evasion is searched
  */
-static int negamax(Position position, int depth, int nodes, int alpha, int beta)
+static int quiescence(Search* search, Position position, int ply, int alpha, int beta)
 {
-  /*
-  if(nodes > 0 && searchedNodes >= nodes)
+  search->nodes++;
+
+  SEARCH_STATS_ADD(search, qnodes);
+
+  search->pv_lengths[ply] = 0;
+
+  if(ply > search->seldepth) search->seldepth = ply;
+
+  if(search_is_stopped(search)) return 0;
+
+  if(ply >= SEARCH_MAX_PLY) return position_side_score_get(position);
+
+  MovePicker picker;
+
+  move_picker_quiescence_init(&picker, &position, search, ply);
+
+  int bestScore = -SCORE_INFINITY;
+
+  if(!picker.checkers)
   {
-    int score = position_score_get(position);
+    bestScore = position_side_score_get(position);
+
+    if(bestScore >= beta) return bestScore;
 
-    return (position.side == SIDE_WHITE) ? score : -score;
+    if(bestScore > alpha) alpha = bestScore;
   }
-  */
 
-  if(depth <= 0)
+  int moveCount = 0;
+
+  Move move;
+
+  while((move = move_picker_next(&picker)) != MOVE_NONE)
   {
-    searchedNodes++;
+    moveCount++;
+
+    Position positionCopy = position;
 
-    int score = position_score_get(position);
+    move_make(&positionCopy, move);
+
+    int currentScore = -quiescence(search, positionCopy, (ply + 1), -beta, -alpha);
+
+    if(currentScore > bestScore) bestScore = currentScore;
+
+    if(bestScore > alpha) alpha = bestScore;
 
-    return (position.side == SIDE_WHITE) ? score : -score;
+    if(alpha >= beta) break;
   }
 
-  int bestScore = -50000;
+  // In check without any evasions is checkmate
+  if(picker.checkers && moveCount <= 0) return -SCORE_MATE + ply;
 
-  MoveArray moveArray;
+  return bestScore;
+}
 
-  memset(moveArray.moves, 0, sizeof(moveArray.moves));
-  moveArray.amount = 0;
+/*
+ * Check if the position is drawn, by the fifty move rule or by repetition
+ *
+ * Only the positions since the last capture or pawn move can repeat,
+ * and only every other of them have the same side to move.
+ * A position that repeats once is scored as a draw,
+ * because the side that can improve would not repeat it
+ */
+static bool position_is_draw(const Search* search, Position position, U64 hashKey)
+{
+  if(position.clock >= 100) return true;
 
-  moves_create(&moveArray, position);
+  int lastIndex = search->key_amount - position.clock;
 
+  if(lastIndex < 0) lastIndex = 0;
 
-  if(moveArray.amount <= 0)
+  for(int index = search->key_amount - 2; index >= lastIndex; index -= 2)
   {
-    // Put this in a new function
-    U64 kingBoard = (position.side == SIDE_WHITE) ? position.boards[PIECE_WHITE_KING] : position.boards[PIECE_BLACK_KING];
+    if(search->keys[index] == hashKey) return true;
+  }
 
-    Square kingSquare = board_first_square_get(kingBoard);
+  return false;
+}
 
-    if(kingSquare == SQUARE_NONE || square_is_attacked(position, kingSquare, !position.side))
+/*
+ *
+ */
+static int negamax(Search* search, Position position, int depth, int ply, int alpha, int beta)
+{
+  // Extend the search of a position in check, to not miss the mates after it
+  if(ply < SEARCH_MAX_PLY && position_checkers_get(&position)) depth++;
+
+  if(depth <= 0 || ply >= SEARCH_MAX_PLY)
+  {
+    return quiescence(search, position, ply, alpha, beta);
+  }
+
+  search->nodes++;
+
+  search->pv_lengths[ply] = 0;
+
+  if(ply > search->seldepth) search->seldepth = ply;
+
+  if(search_is_stopped(search)) return 0;
+
+  U64 hashKey = create_hash_key(position);
+
+  if(position_is_draw(search, position, hashKey)) return 0;
+
+  // A mate closer to the root has already been found, if the bounds cross
+  if(alpha < -SCORE_MATE + ply)    alpha = -SCORE_MATE + ply;
+
+  if(beta  > SCORE_MATE - ply - 1) beta  = SCORE_MATE - ply - 1;
+
+  if(alpha >= beta) return alpha;
+
+  HashEntry* entry = hash_table_entry_get(search->table, hashKey);
+
+  SEARCH_STATS_ADD(search, hash_probes);
+
+  PackedMove hashMove = PACKED_MOVE_NONE;
+
+  if(entry)
+  {
+    SEARCH_STATS_ADD(search, hash_hits);
+
+    hashMove = entry->move;
+
+    int hashScore = hash_score_load_get(entry->score, ply);
+
+    if(entry->depth >= depth && hash_entry_score_cuts(entry, hashScore, alpha, beta))
     {
-      return -49000 + depth;
+      SEARCH_STATS_ADD(search, hash_cutoffs);
+
+      return hashScore;
     }
-    else return 0; // Draw;
   }
 
+  int alphaStart = alpha;
 
-  moves_guess_order(&moveArray, position);
+  int bestScore = -SCORE_INFINITY;
+  Move bestMove = MOVE_NONE;
 
+  MovePicker picker;
 
-  for(int index = 0; index < moveArray.amount; index++)
+  move_picker_init(&picker, &position, search, hashMove, ply);
+
+  int moveCount = 0;
+
+  Move move;
+
+  search->keys[search->key_amount++] = hashKey;
+
+  while((move = move_picker_next(&picker)) != MOVE_NONE)
   {
+    moveCount++;
+
     Position positionCopy = position;
 
-    move_make(&positionCopy, moveArray.moves[index]);
+    move_make(&positionCopy, move);
 
-    int currentScore = -negamax(positionCopy, (depth - 1), nodes, -beta, -alpha);
+    int currentScore = -negamax(search, positionCopy, (depth - 1), (ply + 1), -beta, -alpha);
 
-    if(currentScore > bestScore) bestScore = currentScore;
+    if(search->stopped) break;
 
-    if(bestScore > alpha) alpha = bestScore;
+    if(currentScore > bestScore)
+    {
+      bestScore = currentScore;
+      bestMove = move;
+    }
 
-    if(alpha >= beta) break;
+    if(bestScore > alpha)
+    {
+      alpha = bestScore;
+
+      pv_store(search, ply, move);
+    }
+
+    if(alpha >= beta)
+    {
+      SEARCH_STATS_ADD(search, cutoffs);
+
+      if(moveCount == 1) SEARCH_STATS_ADD(search, first_cutoffs);
+
+      quiet_move_cutoff_store(search, move, depth, ply);
+
+      break;
+    }
+  }
+
+  search->key_amount--;
+
+  if(search->stopped) return 0;
+
+  if(moveCount <= 0)
+  {
+    U64 kingBoard = (position.side == SIDE_WHITE) ? POSITION_BOARD_GET(position, PIECE_WHITE_KING) : POSITION_BOARD_GET(position, PIECE_BLACK_KING);
+
+    if(!kingBoard || picker.checkers)
+    {
+      return -SCORE_MATE + ply;
+    }
+    else return 0; // Draw;
   }
+
+  hash_table_store(search->table, hashKey, depth, hash_score_store_get(bestScore, ply), hash_flag_get(bestScore, alphaStart, beta), bestMove);
+
   return bestScore;
 }
 
 /*
+ * Move the move at the supplied index to the first index,
+ * keeping the order of the moves in between
+ */
+static void move_first_put(MoveArray* moveArray, int firstIndex, int moveIndex)
+{
+  Move move = moveArray->moves[moveIndex];
+
+  for(int index = moveIndex; index > firstIndex; index--)
+  {
+    moveArray->moves[index] = moveArray->moves[index - 1];
+  }
+
+  moveArray->moves[firstIndex] = move;
+}
+
+/*
+ * Print the score of a line, as centipawns or as moves to mate
+ */
+static void score_print(int score)
+{
+  if(score >= SCORE_MATE - SEARCH_MAX_PLY)
+  {
+    printf("score mate %d", (SCORE_MATE - score + 1) / 2);
+  }
+  else if(score <= -SCORE_MATE + SEARCH_MAX_PLY)
+  {
+    printf("score mate %d", -(SCORE_MATE + score) / 2);
+  }
+  else printf("score cp %d", score);
+}
+
+/*
+ * Print an info line about one of the best lines at the root
  *
+ * The packed moves of the line are unpacked by playing them from the root
+ *
+ * PARAMS
+ * - int  lineIndex  | The rank of the line, the best line is 0
+ * - bool lowerbound | The line is the best so far, in a depth that is not done
  */
-Move best_move(Position position, int depth, int nodes, int movetime, MoveArray searchmoves)
+static void root_line_print(const Search* search, Position position, const RootLine* line, int lineIndex, int depth, bool lowerbound)
 {
-  searchedNodes = 0;
+  long time = time_ms_get() - search->start_time;
+
+  U64 nps = (search->nodes * 1000) / (time > 0 ? time : 1);
+
+  printf("info depth %d seldepth %d multipv %d ", depth, search->seldepth, lineIndex + 1);
+
+  score_print(line->score);
+
+  if(lowerbound) printf(" lowerbound");
+
+  printf(" nodes %llu nps %llu time %ld hashfull %d pv", search->nodes, nps, time, hash_table_full_get(search->table));
+
+  char moveString[8];
+
+  for(int index = 0; index < line->length; index++)
+  {
+    Move move = move_unpack(position, line->pv[index]);
+
+    move_string_create(moveString, move);
+
+    printf(" %s", moveString);
+
+    move_make(&position, move);
+  }
+
+  printf("\n");
+
+  fflush(stdout);
+}
+
+/*
+ * Search the root moves from the first index to the supplied depth,
+ * and put the best of them at the first index, for the next line and depth
+ *
+ * The moves before the first index are the best moves of the earlier lines,
+ * and are excluded from the search
+ *
+ * The line gets the score and the principal variation of every new best move,
+ * so if the search is stopped, the moves that were searched to the end
+ * are still used, and the line of the last depth is kept otherwise
+ */
+static void root_moves_search(Search* search, Position position, MoveArray* moveArray, int firstIndex, int depth, RootLine* line)
+{
+  int alpha = -SCORE_INFINITY;
+  int beta  = +SCORE_INFINITY;
+
+  int bestIndex = firstIndex;
+
+  U64 hashKey = create_hash_key(position);
+
+  search->keys[search->key_amount++] = hashKey;
+
+  for(int index = firstIndex; index < moveArray->amount; index++)
+  {
+    Move move = moveArray->moves[index];
+
+    Position positionCopy = position;
+
+    move_make(&positionCopy, move);
+
+    int currentScore = -negamax(search, positionCopy, (depth - 1), 1, -beta, -alpha);
+
+    if(search->stopped) break;
+
+    if(currentScore > alpha)
+    {
+      alpha = currentScore;
+      bestIndex = index;
+
+      pv_store(search, 0, move);
+
+      line->score  = currentScore;
+      line->length = search->pv_lengths[0];
+
+      memcpy(line->pv, search->pv[0], line->length * sizeof(PackedMove));
+
+      // The best move of the last depth was beaten
+      if(search->info && index > firstIndex && firstIndex == 0 && depth > 1)
+      {
+        root_line_print(search, position, line, firstIndex, depth, true);
+      }
+    }
+  }
+
+  search->key_amount--;
+
+  move_first_put(moveArray, firstIndex, bestIndex);
+
+  if(!search->stopped && firstIndex == 0)
+  {
+    hash_table_store(search->table, hashKey, depth, alpha, HASH_FLAG_EXACT, moveArray->moves[0]);
+  }
+}
+
+/*
+ * Get the milliseconds the search can use, from the time left on the clock
+ *
+ * RETURN (long time)
+ * - -1 | The search has no time limit
+ */
+long search_time_limit_get(const SearchLimits* limits)
+{
+  if(limits->movetime >= 0) return limits->movetime;
+
+  if(limits->time < 0) return -1;
+
+  int moves = (limits->movestogo > 0) ? (limits->movestogo + 1) : 30;
+
+  long time = (limits->time / moves) + ((limits->inc > 0) ? (limits->inc / 2) : 0);
+
+  // Keep a margin, so the clock never runs out
+  long most = limits->time - 50;
+
+  if(time > most) time = most;
+
+  return (time > 1) ? time : 1;
+}
+
+/*
+ * Check if there is time for another depth,
+ * which takes longer than all the depths before it
+ *
+ * A search with movetime uses all of its time
+ */
+static bool search_depth_is_last(const Search* search)
+{
+  if(search->time_limit < 0 || search->limits->movetime >= 0) return false;
+
+  if(__atomic_load_n(&search->limits->ponder, __ATOMIC_RELAXED)) return false;
+
+  return (time_ms_get() - search->start_time) >= (search->time_limit / 2);
+}
+
+/*
+ * Search for the best move in the position, with the supplied search state
+ *
+ * The depth, the moves and the time to search are taken from the limits.
+ * With more than one line, every line searches the root moves
+ * that are not the best moves of the lines before it
+ */
+Move best_move_search(Search* search, Position position)
+{
+  const SearchLimits* limits = search->limits;
 
   MoveArray moveArray;
 
   memset(moveArray.moves, 0, sizeof(moveArray.moves));
   moveArray.amount = 0;
 
-  if(searchmoves.amount > 0)
+  if(limits->searchmoves.amount > 0)
   {
-    moveArray = searchmoves;
+    moveArray = limits->searchmoves;
   }
   else
   {
@@ -101,28 +568,145 @@ Move best_move(Position position, int depth, int nodes, int movetime, MoveArray
     if(moveArray.amount <= 0) return MOVE_NONE;
   }
 
+  search->start_time = time_ms_get();
+  search->time_limit = search_time_limit_get(limits);
 
-  int bestScore = -50000;
-  Move bestMove = moveArray.moves[0];
+  int depth = (limits->depth > 0) ? limits->depth : (SEARCH_MAX_PLY - 1);
 
-  for(int index = 0; index < moveArray.amount; index++)
+  int lines = (limits->multipv > 1) ? limits->multipv : 1;
+
+  if(lines > moveArray.amount) lines = moveArray.amount;
+
+  RootLine rootLines[256];
+
+  // If the search is stopped before a move is searched, the lines are empty
+  for(int line = 0; line < lines; line++)
   {
-    Position positionCopy = position;
+    rootLines[line].score  = 0;
+    rootLines[line].length = 0;
+  }
 
-    Move currentMove = moveArray.moves[index];
+  // Iterative deepening, the best moves of the last depth are searched first
+  for(int currentDepth = 1; currentDepth <= depth; currentDepth++)
+  {
+    search->seldepth = 0;
+
+    for(int line = 0; line < lines; line++)
+    {
+      root_moves_search(search, position, &moveArray, line, currentDepth, &rootLines[line]);
+
+      if(search->stopped) break;
+    }
 
-    move_make(&positionCopy, currentMove);
+    if(search->stopped) break;
 
-    int currentScore = -negamax(positionCopy, (depth - 1), nodes, -50000, +50000);
+#ifdef SEARCH_STATS
+    search->stats.depth_nodes[currentDepth] = search->nodes;
+    search->stats.depth = currentDepth;
+#endif // SEARCH_STATS
 
-    if(currentScore > bestScore) 
+    for(int line = 0; search->info && line < lines; line++)
     {
-      bestScore = currentScore;
-      bestMove = currentMove;
+      root_line_print(search, position, &rootLines[line], line, currentDepth, false);
+    }
+
+    if(search_depth_is_last(search)) break;
+  }
+
+#ifdef SEARCH_STATS
+  if(search->info) search_stats_print(search);
+#endif // SEARCH_STATS
+
+  // The principal variation of the best line is kept for the ponder move
+  memcpy(search->pv[0], rootLines[0].pv, rootLines[0].length * sizeof(PackedMove));
+
+  search->pv_lengths[0] = rootLines[0].length;
+
+  search->score = rootLines[0].score;
+
+  return moveArray.moves[0];
+}
+
+/*
+ * Get the move of the hash table in the position, if it is legal
+ */
+static Move hash_move_get(HashTable* table, Position position)
+{
+  HashEntry* entry = hash_table_entry_get(table, create_hash_key(position));
+
+  if(!entry) return MOVE_NONE;
+
+  Move move = move_unpack(position, entry->move);
+
+  if(move == MOVE_NONE || !engine_move_is_legal(position, move)) return MOVE_NONE;
+
+  return move;
+}
+
+/*
+ * Set every limit of the search to not be used
+ */
+void search_limits_init(SearchLimits* limits)
+{
+  memset(limits, 0, sizeof(SearchLimits));
+
+  limits->depth     = -1;
+  limits->nodes     = -1;
+  limits->movetime  = -1;
+  limits->time      = -1;
+  limits->inc       = -1;
+  limits->movestogo = -1;
+  limits->multipv   = 1;
+  limits->mate      = -1;
+}
+
+/*
+ * Search for the best move in the position,
+ * after the positions of the game in the history
+ *
+ * PARAMS
+ * - SearchLimits* limits      | Can be stopped by another thread, while searching
+ * - Move*         ponder_move | The expected reply to the best move, or MOVE_NONE
+ */
+Move best_move(Position position, const KeyHistory* history, SearchLimits* limits, Move* ponder_move)
+{
+  Search search;
+
+  memset(&search, 0, sizeof(search));
+
+  search.table  = &hash_table;
+  search.limits = limits;
+  search.info   = true;
+
+  if(history)
+  {
+    memcpy(search.keys, history->keys, history->amount * sizeof(U64));
+
+    search.key_amount = history->amount;
+  }
+
+  Move bestMove = best_move_search(&search, position);
+
+  if(ponder_move)
+  {
+    *ponder_move = MOVE_NONE;
+
+    if(bestMove != MOVE_NONE)
+    {
+      Position positionCopy = position;
+
+      move_make(&positionCopy, bestMove);
+
+      // The hash table is only used, when the search did not get past the best move
+      if(search.pv_lengths[0] > 1 && search.pv[0][0] == move_pack(bestMove))
+      {
+        *ponder_move = move_unpack(positionCopy, search.pv[0][1]);
+      }
+      else *ponder_move = hash_move_get(search.table, positionCopy);
     }
   }
 
-  if(args.debug) info_print("Searched nodes: %d", searchedNodes);
+  if(args.debug) info_print("Searched nodes: %llu", search.nodes);
 
   return bestMove;
 }
@@ -1,7 +1,7 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #ifndef ENGINE_H
@@ -15,8 +15,121 @@ typedef struct
   int amount;
 } MoveArray;
 
+typedef enum
+{
+  HASH_FLAG_EXACT,
+  HASH_FLAG_ALPHA,
+  HASH_FLAG_BETA
+} HashFlag;
+
+/*
+ * An entry is 16 bytes, so 4 entries fit in a cache line
+ */
+typedef struct
+{
+  U64        key;
+  int        score;
+  PackedMove move;
+  char       depth;
+  char       flag;
+} HashEntry;
+
+typedef struct
+{
+  HashEntry* entries;
+  size_t     amount;
+} HashTable;
+
+#define HASH_TABLE_DEFAULT_SIZE 16
+
+/*
+ * A polyglot opening book, mapped into memory
+ */
+typedef struct
+{
+  const unsigned char* entries;
+  size_t               amount;
+  size_t               size;
+  unsigned int         seed;
+} Book;
+
+#define KEY_HISTORY_SIZE 128
+
+/*
+ * The hash keys of the earlier positions in the game,
+ * since the last capture or pawn move
+ *
+ * Positions before that can not repeat,
+ * and the fifty move rule draws after 100 plies
+ */
+typedef struct
+{
+  U64 keys[KEY_HISTORY_SIZE];
+  int amount;
+} KeyHistory;
+
+/*
+ * The limits of a search, from the go command,
+ * a limit below zero is not used
+ *
+ * mate is the most moves of a mate to search for first,
+ * before the normal search
+ *
+ * stop and ponder are changed by another thread while searching,
+ * and are only read and written atomically
+ */
+typedef struct
+{
+  int       depth;
+  int       nodes;
+  int       movetime;
+  int       time;
+  int       inc;
+  int       movestogo;
+  int       multipv;
+  int       mate;
+  MoveArray searchmoves;
+  bool      infinite;
+  bool      ponder;
+  bool      stop;
+} SearchLimits;
+
+extern HashTable hash_table;
+
+extern int  hash_table_init(HashTable* table, size_t megabytes);
+
+extern void hash_table_clear(HashTable* table);
+
+extern void hash_table_free(HashTable* table);
+
+extern int  hash_table_full_get(const HashTable* table);
+
+extern void key_history_clear(KeyHistory* history);
+
+extern void key_history_push(KeyHistory* history, Position position);
+
+extern long time_ms_get(void);
+
+extern int  book_open(Book* book, const char* filepath);
+
+extern void book_close(Book* book);
+
+extern Move book_move_get(Book* book, Position position);
+
 extern void perft_test(Position position, int depth);
 
-extern Move best_move(Position position, int depth, int nodes, int movetime, MoveArray searchmoves);
+extern void bench_test(int depth);
+
+extern int  analyse_file(const char* input, const char* output, int depth, int thread_amount);
+
+extern int  datagen_file(const char* output, size_t amount, int nodes, int thread_amount);
+
+extern int  selfplay_match(const char* openings, const char* output, const SearchLimits limits[2], int games, int thread_amount, double elo0, double elo1);
+
+extern Move mate_move(Position position, const SearchLimits* limits, int* mate_moves);
+
+extern void search_limits_init(SearchLimits* limits);
+
+extern Move best_move(Position position, const KeyHistory* history, SearchLimits* limits, Move* ponder_move);
 
 #endif // ENGINE_H
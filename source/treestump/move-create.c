@@ -13,7 +13,7 @@ static bool enemy_is_on_target_square(Position position, Piece piece, Square tar
 {
   Side side = PIECE_SIDE_GET(piece);
 
-  return (position.covers[!side] & (1ULL << target_square));
+  return (POSITION_COVER_GET(position, !side) & (1ULL << target_square));
 }
 
 /*
@@ -185,7 +185,7 @@ Move move_create(Position position, Square source_square, Square target_square,
 {
   Move move = MOVE_NONE;
 
-  Piece piece = square_piece_get(position.boards, source_square);
+  Piece piece = square_piece_get(position, source_square);
 
   move |= MOVE_SOURCE_SET(source_square);
   move |= MOVE_TARGET_SET(target_square);
@@ -3,7 +3,7 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
@@ -25,7 +25,7 @@ static bool move_pawn_double_white_is_pseudo_legal(Position position, Move move)
   // Check so no piece is in the way
   U64 move_cover = (1ULL << target_square) | (1ULL << (target_square + BOARD_FILES));
 
-  if(move_cover & position.covers[SIDE_BOTH]) return false;
+  if(move_cover & POSITION_COVER_GET(position, SIDE_BOTH)) return false;
 
   return true;
 }
@@ -47,7 +47,7 @@ static bool move_pawn_double_black_is_pseudo_legal(Position position, Move move)
   // Check so no piece is in the way
   U64 move_cover = (1ULL << target_square) | (1ULL << (target_square - BOARD_FILES));
 
-  if(move_cover & position.covers[SIDE_BOTH]) return false;
+  if(move_cover & POSITION_COVER_GET(position, SIDE_BOTH)) return false;
 
   return true;
 }
@@ -90,10 +90,10 @@ static bool move_pawn_passant_white_is_pseudo_legal(Position position, Move move
   if((moved_squares != -9) && (moved_squares != -7)) return false;
 
   // Check so black pawn is standing next to passant square
-  if(!BOARD_SQUARE_GET(position.boards[PIECE_BLACK_PAWN], (target_square + BOARD_FILES))) return false;
+  if(!BOARD_SQUARE_GET(POSITION_BOARD_GET(position, PIECE_BLACK_PAWN), (target_square + BOARD_FILES))) return false;
 
   // Check so target square is empty
-  if(position.covers[SIDE_BOTH] & (1ULL << target_square)) return false;
+  if(POSITION_COVER_GET(position, SIDE_BOTH) & (1ULL << target_square)) return false;
 
   return true;
 }
@@ -118,10 +118,10 @@ static bool move_pawn_passant_black_is_pseudo_legal(Position position, Move move
   if((moved_squares != +9) && (moved_squares != +7)) return false;
 
   // Check so white pawn is standing next to passant square
-  if(!BOARD_SQUARE_GET(position.boards[PIECE_WHITE_PAWN], (target_square - BOARD_FILES))) return false;
+  if(!BOARD_SQUARE_GET(POSITION_BOARD_GET(position, PIECE_WHITE_PAWN), (target_square - BOARD_FILES))) return false;
 
   // Check so target square is empty
-  if(position.covers[SIDE_BOTH] & (1ULL << target_square)) return false;
+  if(POSITION_COVER_GET(position, SIDE_BOTH) & (1ULL << target_square)) return false;
 
   return true;
 }
@@ -155,11 +155,11 @@ static bool move_pawn_capture_is_pseudo_legal(Position position, Move move)
   Square target_square = MOVE_TARGET_GET(move);
 
   // Check so a piece is standing on target square
-  if(!((1ULL << target_square) & position.covers[SIDE_BOTH])) return false;
+  if(!((1ULL << target_square) & POSITION_COVER_GET(position, SIDE_BOTH))) return false;
 
   // Check so source piece and target piece are not on same side
-  bool targetWhite = ((1ULL << target_square) & position.covers[SIDE_WHITE]);
-  bool sourceWhite = ((1ULL << source_square) & position.covers[SIDE_WHITE]);
+  bool targetWhite = ((1ULL << target_square) & POSITION_COVER_GET(position, SIDE_WHITE));
+  bool sourceWhite = ((1ULL << source_square) & POSITION_COVER_GET(position, SIDE_WHITE));
 
   if(!(sourceWhite ^ targetWhite)) return false;
 
@@ -180,7 +180,7 @@ static bool move_pawn_normal_is_pseudo_legal(Position position, Move move)
   Square target_square = MOVE_TARGET_GET(move);
 
   // Check so no piece is standing on target square
-  if((1ULL << target_square) & position.covers[SIDE_BOTH]) return false;
+  if((1ULL << target_square) & POSITION_COVER_GET(position, SIDE_BOTH)) return false;
 
   // Check so pawn is moving only 1 rank forward
   switch(MOVE_PIECE_GET(move))
@@ -229,18 +229,16 @@ bool move_pawn_is_pseudo_legal(Position position, Move move)
 static bool move_castle_white_king_is_pseudo_legal(Position position)
 {
   // Check so a white rook is standing on H1
-  if(!BOARD_SQUARE_GET(position.boards[PIECE_WHITE_ROOK], H1)) return false;
+  if(!BOARD_SQUARE_GET(POSITION_BOARD_GET(position, PIECE_WHITE_ROOK), H1)) return false;
 
   // Check so no piece is in the way
-  if(position.covers[SIDE_BOTH] & ((1ULL << G1) | (1ULL << F1))) return false;
+  if(POSITION_COVER_GET(position, SIDE_BOTH) & ((1ULL << G1) | (1ULL << F1))) return false;
 
   // Check so the king has right to castle king-side
   if(!(position.castle & CASTLE_WHITE_KING)) return false;
 
   // Check so no square where king moves is attacked by black
-  if(square_is_attacked(position, F1, SIDE_BLACK) ||
-     square_is_attacked(position, G1, SIDE_BLACK) ||
-     square_is_attacked(position, E1, SIDE_BLACK)) return false;
+  if(board_is_attacked(&position, (1ULL << F1) | (1ULL << G1) | (1ULL << E1), SIDE_BLACK)) return false;
 
   return true;
 }
@@ -251,18 +249,16 @@ static bool move_castle_white_king_is_pseudo_legal(Position position)
 static bool move_castle_white_queen_is_pseudo_legal(Position position)
 {
   // Check so a white rook is standing on A1
-  if(!BOARD_SQUARE_GET(position.boards[PIECE_WHITE_ROOK], A1)) return false;
+  if(!BOARD_SQUARE_GET(POSITION_BOARD_GET(position, PIECE_WHITE_ROOK), A1)) return false;
 
   // Check so no piece is in the way
-  if(position.covers[SIDE_BOTH] & ((1ULL << B1) | (1ULL << C1) | (1ULL << D1))) return false;
+  if(POSITION_COVER_GET(position, SIDE_BOTH) & ((1ULL << B1) | (1ULL << C1) | (1ULL << D1))) return false;
 
   // Check so the king has right to castle queen-side
   if(!(position.castle & CASTLE_WHITE_QUEEN)) return false;
 
   // Check so no square where king moves is attacked by black
-  if(square_is_attacked(position, C1, SIDE_BLACK) ||
-     square_is_attacked(position, D1, SIDE_BLACK) ||
-     square_is_attacked(position, E1, SIDE_BLACK)) return false;
+  if(board_is_attacked(&position, (1ULL << C1) | (1ULL << D1) | (1ULL << E1), SIDE_BLACK)) return false;
 
   return true;
 }
@@ -293,18 +289,16 @@ static bool move_castle_white_is_pseudo_legal(Position position, Move move)
 static bool move_castle_black_king_is_pseudo_legal(Position position)
 {
   // Check so a white rook is standing on H8
-  if(!BOARD_SQUARE_GET(position.boards[PIECE_BLACK_ROOK], H8)) return false;
+  if(!BOARD_SQUARE_GET(POSITION_BOARD_GET(position, PIECE_BLACK_ROOK), H8)) return false;
 
   // Check so no piece is in the way
-  if(position.covers[SIDE_BOTH] & ((1ULL << G8) | (1ULL << F8))) return false;
+  if(POSITION_COVER_GET(position, SIDE_BOTH) & ((1ULL << G8) | (1ULL << F8))) return false;
 
   // Check so the king has right to castle king-side
   if(!(position.castle & CASTLE_BLACK_KING)) return false;
 
   // Check so no square where king moves is attacked by white
-  if(square_is_attacked(position, G8, SIDE_WHITE) ||
-     square_is_attacked(position, F8, SIDE_WHITE) ||
-     square_is_attacked(position, E8, SIDE_WHITE)) return false;
+  if(board_is_attacked(&position, (1ULL << G8) | (1ULL << F8) | (1ULL << E8), SIDE_WHITE)) return false;
 
   return true;
 }
@@ -315,18 +309,16 @@ static bool move_castle_black_king_is_pseudo_legal(Position position)
 static bool move_castle_black_queen_is_pseudo_legal(Position position)
 {
   // Check so a white rook is standing on A8
-  if(!BOARD_SQUARE_GET(position.boards[PIECE_BLACK_ROOK], A8)) return false;
+  if(!BOARD_SQUARE_GET(POSITION_BOARD_GET(position, PIECE_BLACK_ROOK), A8)) return false;
 
   // Check so no piece is in the way
-  if(position.covers[SIDE_BOTH] & ((1ULL << B8) | (1ULL << C8) | (1ULL << D8))) return false;
+  if(POSITION_COVER_GET(position, SIDE_BOTH) & ((1ULL << B8) | (1ULL << C8) | (1ULL << D8))) return false;
 
   // Check so the king has right to castle queen-side
   if(!(position.castle & CASTLE_BLACK_QUEEN)) return false;
 
   // Check so no square where king moves is attacked by white
-  if(square_is_attacked(position, C8, SIDE_WHITE) ||
-     square_is_attacked(position, D8, SIDE_WHITE) ||
-     square_is_attacked(position, E8, SIDE_WHITE)) return false;
+  if(board_is_attacked(&position, (1ULL << C8) | (1ULL << D8) | (1ULL << E8), SIDE_WHITE)) return false;
 
   return true;
 }
@@ -380,12 +372,12 @@ static bool move_normal_is_pseudo_legal(Position position, Move move)
   Piece piece = MOVE_PIECE_GET(move);
 
   // Check so the moving piece is on the source square
-  if(!BOARD_SQUARE_GET(position.boards[piece], source_square))
+  if(!BOARD_SQUARE_GET(POSITION_BOARD_GET(position, piece), source_square))
   {
     return false;
   }
 
-  bool target_is_piece = BOARD_SQUARE_GET(position.covers[SIDE_BOTH], target_square);
+  bool target_is_piece = BOARD_SQUARE_GET(POSITION_COVER_GET(position, SIDE_BOTH), target_square);
 
   // Check so the target exist if there is a capture
   if(((move & MOVE_MASK_CAPTURE) ? 1 : 0) ^ target_is_piece)
@@ -393,8 +385,8 @@ static bool move_normal_is_pseudo_legal(Position position, Move move)
     return false;
   }
 
-  bool source_is_white = BOARD_SQUARE_GET(position.covers[SIDE_WHITE], source_square);
-  bool target_is_white = BOARD_SQUARE_GET(position.covers[SIDE_WHITE], target_square);
+  bool source_is_white = BOARD_SQUARE_GET(POSITION_COVER_GET(position, SIDE_WHITE), source_square);
+  bool target_is_white = BOARD_SQUARE_GET(POSITION_COVER_GET(position, SIDE_WHITE), target_square);
 
   // Check so source piece and target piece are not on same side, in case of capture
   if((move & MOVE_MASK_CAPTURE) && !(source_is_white ^ target_is_white))
@@ -403,7 +395,7 @@ static bool move_normal_is_pseudo_legal(Position position, Move move)
   }
 
   // Check so there are no pieces in the way
-  if(BOARD_LINES[source_square][target_square] & position.covers[SIDE_BOTH])
+  if(BOARD_LINES[source_square][target_square] & POSITION_COVER_GET(position, SIDE_BOTH))
   {
     return false;
   }
@@ -448,7 +440,7 @@ Square king_square_get(Position position, Side side)
 {
   Piece king_piece = (side == SIDE_WHITE) ? PIECE_WHITE_KING : PIECE_BLACK_KING;
 
-  return board_first_square_get(position.boards[king_piece]);
+  return board_first_square_get(POSITION_BOARD_GET(position, king_piece));
 }
 
 /*
@@ -474,5 +466,7 @@ bool move_is_legal(Position position, Move move)
   // If the king does not exist, the move can no way be legal
   if(king_square == SQUARE_NONE) return false;
 
-  return !square_is_attacked(moved_position, king_square, moved_position.side);
+  U64 attackers = square_attackers_get(&moved_position, king_square, POSITION_COVER_GET(moved_position, SIDE_BOTH));
+
+  return !(attackers & moved_position.sides[moved_position.side]);
 }
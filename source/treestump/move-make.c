@@ -6,7 +6,7 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-11
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
@@ -29,9 +29,8 @@ static void position_piece_move(Position* position, Piece piece, Square source,
   U64  move_board = (1ULL << source) ^ (1ULL << target);
   Side side = PIECE_SIDE_GET(piece);
 
-  position->boards[piece]     ^= move_board;
-  position->covers[side]      ^= move_board;
-  position->covers[SIDE_BOTH] ^= move_board;
+  position->types[PIECE_TYPE_GET(piece)] ^= move_board;
+  position->sides[side]                  ^= move_board;
 }
 
 /*
@@ -46,15 +45,15 @@ static void position_piece_move(Position* position, Piece piece, Square source,
  */
 static void position_square_piece_pick_up(Position* position, Square square)
 {
-  Piece piece = square_piece_get(position->boards, square);
+  Piece piece = square_piece_get(*position, square);
   
   if(piece == PIECE_NONE) return;
 
-  Side side = PIECE_SIDE_GET(piece);
+  PieceType type = PIECE_TYPE_GET(piece);
+  Side      side = PIECE_SIDE_GET(piece);
 
-  position->boards[piece]     = BOARD_SQUARE_POP(position->boards[piece],     square);
-  position->covers[side]      = BOARD_SQUARE_POP(position->covers[side],      square);
-  position->covers[SIDE_BOTH] = BOARD_SQUARE_POP(position->covers[SIDE_BOTH], square);
+  position->types[type] = BOARD_SQUARE_POP(position->types[type], square);
+  position->sides[side] = BOARD_SQUARE_POP(position->sides[side], square);
 }
 
 /*
@@ -74,10 +73,11 @@ static void position_pawn_promote(Position* position, Piece pawn_piece, Square p
   U64  move_board = (1ULL << pawn_square) ^ (1ULL << promote_square);
   Side side = PIECE_SIDE_GET(pawn_piece);
 
-  position->boards[promote_piece] = BOARD_SQUARE_SET(position->boards[promote_piece], promote_square);
-  position->boards[pawn_piece]    = BOARD_SQUARE_POP(position->boards[pawn_piece],    pawn_square);
-  position->covers[side]      ^= move_board;
-  position->covers[SIDE_BOTH] ^= move_board;
+  PieceType promote_type = PIECE_TYPE_GET(promote_piece);
+
+  position->types[promote_type]    = BOARD_SQUARE_SET(position->types[promote_type],    promote_square);
+  position->types[PIECE_TYPE_PAWN] = BOARD_SQUARE_POP(position->types[PIECE_TYPE_PAWN], pawn_square);
+  position->sides[side] ^= move_board;
 }
 
 #define CASTLE_ROOK_SOURCE_GET(SOURCE, TARGET) ((TARGET) > (SOURCE)) ? ((SOURCE) + 3) : ((SOURCE) - 4)
@@ -0,0 +1,120 @@
+/*
+ * Pack moves into 16 bits and unpack them again
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+/*
+ * Get the packed kind of a move, which is either a special move or a promotion
+ */
+static PackedKind move_packed_kind_get(Move move)
+{
+  if(move & MOVE_MASK_CASTLE)  return PACKED_KIND_CASTLE;
+
+  if(move & MOVE_MASK_DOUBLE)  return PACKED_KIND_DOUBLE;
+
+  if(move & MOVE_MASK_PASSANT) return PACKED_KIND_PASSANT;
+
+  if(move & MOVE_MASK_PROMOTE)
+  {
+    Piece promote_piece = MOVE_PROMOTE_GET(move);
+
+    // Both white and black promote pieces get the same kind
+    if(promote_piece >= PIECE_BLACK_PAWN) promote_piece -= PIECE_BLACK_PAWN;
+
+    return PACKED_KIND_KNIGHT + (promote_piece - PIECE_WHITE_KNIGHT);
+  }
+
+  return PACKED_KIND_NORMAL;
+}
+
+/*
+ * Pack a move into 16 bits, with source, target and kind of move
+ */
+PackedMove move_pack(Move move)
+{
+  if(move == MOVE_NONE) return PACKED_MOVE_NONE;
+
+  PackedMove packed = PACKED_MOVE_NONE;
+
+  packed |= PACKED_SOURCE_SET(MOVE_SOURCE_GET(move));
+  packed |= PACKED_TARGET_SET(MOVE_TARGET_GET(move));
+
+  packed |= PACKED_KIND_SET(move_packed_kind_get(move));
+
+  return packed;
+}
+
+/*
+ * Get the promote piece of a packed kind, for the side of the pawn
+ */
+static Piece packed_kind_promote_get(PackedKind kind, Piece pawn_piece)
+{
+  Piece promote_piece = PIECE_WHITE_KNIGHT + (kind - PACKED_KIND_KNIGHT);
+
+  if(PIECE_SIDE_GET(pawn_piece) == SIDE_BLACK) promote_piece += PIECE_BLACK_PAWN;
+
+  return promote_piece;
+}
+
+/*
+ * Unpack a packed move, by getting the moving piece from the position
+ *
+ * The move is not validated, only given the information
+ * it would have had if it was created in the position
+ *
+ * RETURN (Move move)
+ * - MOVE_NONE | No piece is standing on the source square
+ */
+Move move_unpack(Position position, PackedMove packed)
+{
+  if(packed == PACKED_MOVE_NONE) return MOVE_NONE;
+
+  Square source_square = PACKED_SOURCE_GET(packed);
+  Square target_square = PACKED_TARGET_GET(packed);
+
+  Piece piece = square_piece_get(position, source_square);
+
+  if(piece == PIECE_NONE) return MOVE_NONE;
+
+  Move move = MOVE_NONE;
+
+  move |= MOVE_SOURCE_SET(source_square);
+  move |= MOVE_TARGET_SET(target_square);
+  move |= MOVE_PIECE_SET(piece);
+
+  PackedKind kind = PACKED_KIND_GET(packed);
+
+  switch(kind)
+  {
+    case PACKED_KIND_NORMAL:
+      break;
+
+    case PACKED_KIND_DOUBLE:
+      move |= MOVE_MASK_DOUBLE;
+      break;
+
+    case PACKED_KIND_PASSANT:
+      move |= MOVE_MASK_PASSANT;
+      break;
+
+    case PACKED_KIND_CASTLE:
+      move |= MOVE_MASK_CASTLE;
+      break;
+
+    default:
+      move |= MOVE_PROMOTE_SET(packed_kind_promote_get(kind, piece));
+      break;
+  }
+
+  if(BOARD_SQUARE_GET(POSITION_COVER_GET(position, SIDE_BOTH), target_square))
+  {
+    move |= MOVE_MASK_CAPTURE;
+  }
+
+  return move;
+}
@@ -1,7 +1,7 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-11
+ * Last updated: 2026-10-19
  */
 
 #ifndef MOVE_H
@@ -37,6 +37,44 @@ extern const Move MOVE_NONE;
 #define MOVE_PIECE_SET(PIECE)     (((PIECE)   << MOVE_SHIFT_PIECE)   & MOVE_MASK_PIECE)
 #define MOVE_PROMOTE_SET(PROMOTE) (((PROMOTE) << MOVE_SHIFT_PROMOTE) & MOVE_MASK_PROMOTE)
 
+/*
+ * A move packed into 16 bits, for storing in the hash table, killers and PV
+ *
+ * The moving piece and the capture flag are not stored,
+ * they are recovered from the position when the move is unpacked
+ */
+typedef unsigned short PackedMove;
+
+typedef enum
+{
+  PACKED_KIND_NORMAL,
+  PACKED_KIND_DOUBLE,
+  PACKED_KIND_PASSANT,
+  PACKED_KIND_CASTLE,
+  PACKED_KIND_KNIGHT,
+  PACKED_KIND_BISHOP,
+  PACKED_KIND_ROOK,
+  PACKED_KIND_QUEEN
+} PackedKind;
+
+#define PACKED_MOVE_NONE 0
+
+#define PACKED_MASK_SOURCE 0x003f
+#define PACKED_MASK_TARGET 0x0fc0
+#define PACKED_MASK_KIND   0xf000
+
+#define PACKED_SHIFT_SOURCE 0
+#define PACKED_SHIFT_TARGET 6
+#define PACKED_SHIFT_KIND   12
+
+#define PACKED_SOURCE_GET(PACKED) (((PACKED) & PACKED_MASK_SOURCE) >> PACKED_SHIFT_SOURCE)
+#define PACKED_TARGET_GET(PACKED) (((PACKED) & PACKED_MASK_TARGET) >> PACKED_SHIFT_TARGET)
+#define PACKED_KIND_GET(PACKED)   (((PACKED) & PACKED_MASK_KIND)   >> PACKED_SHIFT_KIND)
+
+#define PACKED_SOURCE_SET(SOURCE) (((SOURCE) << PACKED_SHIFT_SOURCE) & PACKED_MASK_SOURCE)
+#define PACKED_TARGET_SET(TARGET) (((TARGET) << PACKED_SHIFT_TARGET) & PACKED_MASK_TARGET)
+#define PACKED_KIND_SET(KIND)     (((KIND)   << PACKED_SHIFT_KIND)   & PACKED_MASK_KIND)
+
 extern void move_make(Position* position, Move move);
 
 
@@ -51,6 +89,11 @@ extern Move move_normal_create(Position position, Square source_square, Square t
 extern Move move_create(Position position, Square source_square, Square target_square, Piece promote_piece);
 
 
+extern PackedMove move_pack(Move move);
+
+extern Move move_unpack(Position position, PackedMove packed);
+
+
 extern Square king_square_get(Position position, Side side);
 
 extern bool move_is_legal(Position position, Move move);
@@ -1,16 +1,88 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
 
 #include "piece-intern.h"
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#include <cpuid.h>
+#endif // __x86_64__
+
+static AttacksBackend attacks_backend = ATTACKS_BACKEND_MAGIC;
+
+#ifdef ATTACKS_PLAIN
+
+/*
+ * Plain magic bitboards
+ *
+ * Every square gets room for the largest amount of covers,
+ * even if most squares need far fewer entries (about 2.3 MB)
+ */
 U64 ATTACKS_BISHOP[BOARD_SQUARES][512];
 U64 ATTACKS_ROOK  [BOARD_SQUARES][4096];
 
+#define ATTACKS_BISHOP_ENTRY(SQUARE, INDEX) (ATTACKS_BISHOP[(SQUARE)][(INDEX)])
+#define ATTACKS_ROOK_ENTRY(SQUARE, INDEX)   (ATTACKS_ROOK  [(SQUARE)][(INDEX)])
+
+#else // ATTACKS_PLAIN
+
+/*
+ * Fancy magic bitboards
+ *
+ * Every square only gets room for its own amount of covers,
+ * at an offset into one shared table (about 840 KB)
+ */
+#ifdef ATTACKS_GENERATED
+
+// Points to the generated table of the backend in use
+static const U64* ATTACKS_TABLE = ATTACKS_TABLE_MAGIC;
+
+#else // ATTACKS_GENERATED
+
+U64 ATTACKS_TABLE[ATTACKS_TABLE_SIZE];
+
+int OFFSETS_BISHOP[BOARD_SQUARES];
+int OFFSETS_ROOK  [BOARD_SQUARES];
+
+#endif // ATTACKS_GENERATED
+
+#define ATTACKS_BISHOP_ENTRY(SQUARE, INDEX) (ATTACKS_TABLE[OFFSETS_BISHOP[(SQUARE)] + (INDEX)])
+#define ATTACKS_ROOK_ENTRY(SQUARE, INDEX)   (ATTACKS_TABLE[OFFSETS_ROOK  [(SQUARE)] + (INDEX)])
+
+#ifndef ATTACKS_GENERATED
+
+/*
+ * Give every square an offset into the shared attacks table,
+ * the rook attacks are put first and the bishop attacks after
+ */
+static void attacks_offsets_init(void)
+{
+  int offset = 0;
+
+  for(Square square = 0; square < BOARD_SQUARES; square++)
+  {
+    OFFSETS_ROOK[square] = offset;
+
+    offset += (1 << RELEVANT_BITS_ROOK[square]);
+  }
+
+  for(Square square = 0; square < BOARD_SQUARES; square++)
+  {
+    OFFSETS_BISHOP[square] = offset;
+
+    offset += (1 << RELEVANT_BITS_BISHOP[square]);
+  }
+}
+
+#endif // ATTACKS_GENERATED
+
+#endif // ATTACKS_PLAIN
+
 /*
  *
  */
@@ -20,9 +92,7 @@ U64 index_cover_create(int index, U64 attackMask, int bitAmount)
 
   for(int amount = 0; amount < bitAmount; amount++)
   {
-    int square = board_first_square_get(attackMask);
-
-    attackMask = BOARD_SQUARE_POP(attackMask, square);
+    int square = board_first_square_pop(&attackMask);
 
     if(index & (1 << amount)) cover |= (1ULL << square);
   }
@@ -113,6 +183,8 @@ U64 attacks_rook_create(Square square, U64 cover)
   return attacks;
 }
 
+#ifndef ATTACKS_GENERATED
+
 /*
  *
  */
@@ -121,11 +193,92 @@ static int magic_index_create(U64 cover, U64 magic_number, int relevant_bits)
   return ((cover * magic_number) >> (BOARD_SQUARES - relevant_bits));
 }
 
+#endif // ATTACKS_GENERATED
+
+#ifdef __x86_64__
+
+/*
+ * Extract the bits of the cover that are in the mask,
+ * which gives the same index as index_cover_create was given
+ */
+__attribute__((target("bmi2")))
+static int pext_index_create(U64 cover, U64 mask)
+{
+  return (int) _pext_u64(cover, mask);
+}
+
+/*
+ * Check if the CPU can execute PEXT fast enough to replace the magic numbers
+ *
+ * AMD processors before Zen 3 execute PEXT in microcode,
+ * which makes it slower than the magic multiplication
+ */
+static bool cpu_pext_is_fast(void)
+{
+  __builtin_cpu_init();
+
+  if(!__builtin_cpu_supports("bmi2")) return false;
+
+  if(!__builtin_cpu_is("amd")) return true;
+
+  unsigned int eax, ebx, ecx, edx;
+
+  if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+
+  unsigned int family = (eax >> 8) & 0xf;
+
+  if(family == 0xf) family += (eax >> 20) & 0xff;
+
+  return (family >= 0x19);
+}
+
+#endif // __x86_64__
+
+/*
+ * Decide what backend to use for sliding attacks
+ *
+ * If PEXT is not supported by the CPU, magic numbers are used instead
+ */
+static AttacksBackend attacks_backend_select(AttacksBackend backend)
+{
+#ifdef __x86_64__
+  switch(backend)
+  {
+    case ATTACKS_BACKEND_AUTO:
+      return cpu_pext_is_fast() ? ATTACKS_BACKEND_PEXT : ATTACKS_BACKEND_MAGIC;
+
+    case ATTACKS_BACKEND_PEXT:
+      __builtin_cpu_init();
+
+      if(__builtin_cpu_supports("bmi2")) return ATTACKS_BACKEND_PEXT;
+
+      if(args.debug) error_print("PEXT is not supported by the CPU");
+
+      return ATTACKS_BACKEND_MAGIC;
+
+    default:
+      return ATTACKS_BACKEND_MAGIC;
+  }
+#else // __x86_64__
+  return ATTACKS_BACKEND_MAGIC;
+#endif // __x86_64__
+}
+
+/*
+ * Get the name of the backend used for sliding attacks
+ */
+const char* attacks_backend_name_get(void)
+{
+  return (attacks_backend == ATTACKS_BACKEND_PEXT) ? "pext" : "magic";
+}
+
+#ifndef ATTACKS_GENERATED
+
 /*
  * Initialize lookup attacks for a rook
  * at every square and with every case of cover
  */
-static void attacks_rook_init(void)
+static void attacks_rook_init(AttacksBackend backend)
 {
   for (Square square = 0; square < BOARD_SQUARES; square++)
   {
@@ -137,9 +290,11 @@ static void attacks_rook_init(void)
     {
       U64 cover = index_cover_create(index, MASKS_ROOK[square], relevantBits);
 
-      int magicIndex = magic_index_create(cover, MAGIC_NUMBERS_ROOK[square], relevantBits);
+      // With PEXT, the index is the same as the one that created the cover
+      int attackIndex = (backend == ATTACKS_BACKEND_PEXT) ? index :
+                        magic_index_create(cover, MAGIC_NUMBERS_ROOK[square], relevantBits);
 
-      ATTACKS_ROOK[square][magicIndex] = attacks_rook_create(square, cover);
+      ATTACKS_ROOK_ENTRY(square, attackIndex) = attacks_rook_create(square, cover);
     }
   }
 }
@@ -148,7 +303,7 @@ static void attacks_rook_init(void)
  * Initialize lookup attacks for a bishop
  * at every square and with every case of cover
  */
-static void attacks_bishop_init(void)
+static void attacks_bishop_init(AttacksBackend backend)
 {
   for (Square square = 0; square < BOARD_SQUARES; square++)
   {
@@ -160,25 +315,82 @@ static void attacks_bishop_init(void)
     {
       U64 cover = index_cover_create(index, MASKS_BISHOP[square], relevantBits);
 
-      int magicIndex = magic_index_create(cover, MAGIC_NUMBERS_BISHOP[square], relevantBits);
+      // With PEXT, the index is the same as the one that created the cover
+      int attackIndex = (backend == ATTACKS_BACKEND_PEXT) ? index :
+                        magic_index_create(cover, MAGIC_NUMBERS_BISHOP[square], relevantBits);
 
-      ATTACKS_BISHOP[square][magicIndex] = attacks_bishop_create(square, cover);
+      ATTACKS_BISHOP_ENTRY(square, attackIndex) = attacks_bishop_create(square, cover);
     }
   }
 }
 
 /*
+ * Fill in the lookup attacks tables, indexed the way the backend indexes them
  *
+ * The backend is not checked against the CPU,
+ * so the tables can be generated for a CPU without PEXT
  */
-void attacks_init(void)
+void attacks_tables_init(AttacksBackend backend)
 {
-  if(args.debug) info_print("Initializing attacks");
+#ifndef ATTACKS_PLAIN
+  attacks_offsets_init();
+#endif // ATTACKS_PLAIN
 
-  attacks_rook_init();
+  attacks_rook_init(backend);
 
-  attacks_bishop_init();
+  attacks_bishop_init(backend);
 }
 
+#endif // ATTACKS_GENERATED
+
+/*
+ * Initialize lookup attacks for the supplied backend
+ *
+ * PARAMS
+ * - AttacksBackend backend | Backend to use, or ATTACKS_BACKEND_AUTO to check the CPU
+ */
+void attacks_init(AttacksBackend backend)
+{
+  attacks_backend = attacks_backend_select(backend);
+
+  if(args.debug) info_print("Initializing attacks (%s)", attacks_backend_name_get());
+
+#ifdef ATTACKS_GENERATED
+#ifdef __x86_64__
+  if(attacks_backend == ATTACKS_BACKEND_PEXT) ATTACKS_TABLE = ATTACKS_TABLE_PEXT;
+#endif // __x86_64__
+#else // ATTACKS_GENERATED
+  attacks_tables_init(attacks_backend);
+#endif // ATTACKS_GENERATED
+}
+
+#ifdef __x86_64__
+
+/*
+ * The whole pext lookups are compiled for BMI2,
+ * so that pext_index_create can be inlined into them
+ */
+__attribute__((target("bmi2")))
+static U64 attacks_bishop_cover_pext_get(Square square, U64 cover)
+{
+  int coverIndex = pext_index_create(cover, MASKS_BISHOP[square]);
+
+  return ATTACKS_BISHOP_ENTRY(square, coverIndex);
+}
+
+/*
+ *
+ */
+__attribute__((target("bmi2")))
+static U64 attacks_rook_cover_pext_get(Square square, U64 cover)
+{
+  int coverIndex = pext_index_create(cover, MASKS_ROOK[square]);
+
+  return ATTACKS_ROOK_ENTRY(square, coverIndex);
+}
+
+#endif // __x86_64__
+
 /*
  *
  */
@@ -212,37 +424,72 @@ static int cover_index_rook_get(Square square, U64 cover)
 }
 
 /*
+ * Lookup a board of attacks for a bishop, with the supplied cover
  *
+ * The cover does not have to be the cover of a position,
+ * ex: the cover with some pieces removed
  */
-U64 attacks_bishop_get(Square square, Position position)
+U64 attacks_bishop_cover_get(Square square, U64 cover)
 {
-  int coverIndex = cover_index_bishop_get(square, position.covers[SIDE_BOTH]);
+#ifdef __x86_64__
+  if(attacks_backend == ATTACKS_BACKEND_PEXT)
+  {
+    return attacks_bishop_cover_pext_get(square, cover);
+  }
+#endif // __x86_64__
 
-  return ATTACKS_BISHOP[square][coverIndex];
+  int coverIndex = cover_index_bishop_get(square, cover);
+
+  return ATTACKS_BISHOP_ENTRY(square, coverIndex);
 }
 
 /*
- *
+ * Lookup a board of attacks for a rook, with the supplied cover
  */
-U64 attacks_rook_get(Square square, Position position)
+U64 attacks_rook_cover_get(Square square, U64 cover)
 {
-  int coverIndex = cover_index_rook_get(square, position.covers[SIDE_BOTH]);
+#ifdef __x86_64__
+  if(attacks_backend == ATTACKS_BACKEND_PEXT)
+  {
+    return attacks_rook_cover_pext_get(square, cover);
+  }
+#endif // __x86_64__
+
+  int coverIndex = cover_index_rook_get(square, cover);
 
-  return ATTACKS_ROOK[square][coverIndex];
+  return ATTACKS_ROOK_ENTRY(square, coverIndex);
 }
 
 /*
- *
+ * Lookup a board of attacks for a queen, with the supplied cover
  */
-U64 attacks_queen_get(Square square, Position position)
+U64 attacks_queen_cover_get(Square square, U64 cover)
 {
-  U64 queenAttacks = 0ULL;
+  return attacks_bishop_cover_get(square, cover) | attacks_rook_cover_get(square, cover);
+}
 
-  queenAttacks |= attacks_bishop_get(square, position);
+/*
+ *
+ */
+U64 attacks_bishop_get(Square square, Position position)
+{
+  return attacks_bishop_cover_get(square, POSITION_COVER_GET(position, SIDE_BOTH));
+}
 
-  queenAttacks |= attacks_rook_get(square, position);
+/*
+ *
+ */
+U64 attacks_rook_get(Square square, Position position)
+{
+  return attacks_rook_cover_get(square, POSITION_COVER_GET(position, SIDE_BOTH));
+}
 
-  return queenAttacks;
+/*
+ *
+ */
+U64 attacks_queen_get(Square square, Position position)
+{
+  return attacks_queen_cover_get(square, POSITION_COVER_GET(position, SIDE_BOTH));
 }
 
 /*
@@ -276,7 +523,7 @@ U64 attacks_king_get(Square square)
  */
 U64 attacks_get(Square square, Position position)
 {
-  switch(square_piece_get(position.boards, square))
+  switch(square_piece_get(position, square))
   {
     case PIECE_WHITE_KING: case PIECE_BLACK_KING:
       return attacks_king_get(square);
@@ -1,20 +1,55 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #ifndef PIECE_INTERN_H
 #define PIECE_INTERN_H
 
-extern U64 MASKS_BISHOP [BOARD_SQUARES];
-extern U64 MASKS_ROOK   [BOARD_SQUARES];
-extern U64 MASKS_PAWN[2][BOARD_SQUARES];
-extern U64 MASKS_KNIGHT [BOARD_SQUARES];
-extern U64 MASKS_KING   [BOARD_SQUARES];
+// The plain attacks tables are too large to be generated,
+// so they are always filled in at startup
+#if defined(TABLES_GENERATED) && !defined(ATTACKS_PLAIN)
+#define ATTACKS_GENERATED
+#endif
 
-extern int RELEVANT_BITS_BISHOP[BOARD_SQUARES];
-extern int RELEVANT_BITS_ROOK  [BOARD_SQUARES];
+extern TABLE_CONST U64 MASKS_BISHOP [BOARD_SQUARES];
+extern TABLE_CONST U64 MASKS_ROOK   [BOARD_SQUARES];
+extern TABLE_CONST U64 MASKS_PAWN[2][BOARD_SQUARES];
+extern TABLE_CONST U64 MASKS_KNIGHT [BOARD_SQUARES];
+extern TABLE_CONST U64 MASKS_KING   [BOARD_SQUARES];
+
+extern TABLE_CONST int RELEVANT_BITS_BISHOP[BOARD_SQUARES];
+extern TABLE_CONST int RELEVANT_BITS_ROOK  [BOARD_SQUARES];
+
+#ifdef ATTACKS_PLAIN
+
+extern U64 ATTACKS_BISHOP[BOARD_SQUARES][512];
+extern U64 ATTACKS_ROOK  [BOARD_SQUARES][4096];
+
+#else // ATTACKS_PLAIN
+
+#define ATTACKS_TABLE_SIZE (102400 + 5248)
+
+extern TABLE_CONST int OFFSETS_BISHOP[BOARD_SQUARES];
+extern TABLE_CONST int OFFSETS_ROOK  [BOARD_SQUARES];
+
+#ifdef ATTACKS_GENERATED
+
+// Both backends index the table differently, so both tables are generated
+extern const U64 ATTACKS_TABLE_MAGIC[ATTACKS_TABLE_SIZE];
+
+#ifdef __x86_64__
+extern const U64 ATTACKS_TABLE_PEXT [ATTACKS_TABLE_SIZE];
+#endif // __x86_64__
+
+#else // ATTACKS_GENERATED
+
+extern U64 ATTACKS_TABLE[ATTACKS_TABLE_SIZE];
+
+#endif // ATTACKS_GENERATED
+
+#endif // ATTACKS_PLAIN
 
 extern const U64 MAGIC_NUMBERS_BISHOP[BOARD_SQUARES];
 extern const U64 MAGIC_NUMBERS_ROOK  [BOARD_SQUARES];
@@ -26,4 +61,10 @@ extern U64 attacks_bishop_create(Square square, U64 block);
 
 extern U64 attacks_rook_create(Square square, U64 block);
 
+#ifndef ATTACKS_GENERATED
+
+extern void attacks_tables_init(AttacksBackend backend);
+
+#endif // ATTACKS_GENERATED
+
 #endif // PIECE_INTERN_H
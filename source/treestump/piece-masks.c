@@ -1,11 +1,14 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
 
+// The masks are generated at build time instead
+#ifndef TABLES_GENERATED
+
 U64 MASKS_BISHOP [BOARD_SQUARES];
 U64 MASKS_ROOK   [BOARD_SQUARES];
 U64 MASKS_PAWN[2][BOARD_SQUARES];
@@ -182,3 +185,5 @@ void relevant_bits_init(void)
     RELEVANT_BITS_ROOK  [square] = board_bit_amount_get(MASKS_ROOK  [square]);
   }
 }
+
+#endif // TABLES_GENERATED
@@ -1,7 +1,7 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #ifndef PIECE_H
@@ -26,17 +26,52 @@ typedef enum
   PIECE_NONE
 } Piece;
 
+typedef enum
+{
+  PIECE_TYPE_PAWN,
+  PIECE_TYPE_KNIGHT,
+  PIECE_TYPE_BISHOP,
+  PIECE_TYPE_ROOK,
+  PIECE_TYPE_QUEEN,
+  PIECE_TYPE_KING,
+  PIECE_TYPE_NONE
+} PieceType;
+
 #define PIECE_SIDE_GET(PIECE) (((PIECE) >= PIECE_WHITE_PAWN && (PIECE) <= PIECE_WHITE_KING) ? SIDE_WHITE : SIDE_BLACK)
 
+#define PIECE_TYPE_GET(PIECE) (((PIECE) >= PIECE_BLACK_PAWN) ? ((PIECE) - PIECE_BLACK_PAWN) : (PIECE))
+
+#define PIECE_CREATE(TYPE, SIDE) (((SIDE) == SIDE_WHITE) ? (TYPE) : ((TYPE) + PIECE_BLACK_PAWN))
+
+typedef enum
+{
+  ATTACKS_BACKEND_AUTO,
+  ATTACKS_BACKEND_MAGIC,
+  ATTACKS_BACKEND_PEXT
+} AttacksBackend;
+
 // Remove extern from this, and create getter like for attacks
-extern U64 BOARD_LINES[BOARD_SQUARES][BOARD_SQUARES];
+extern TABLE_CONST U64 BOARD_LINES[BOARD_SQUARES][BOARD_SQUARES];
 
-extern void attacks_init(void);
+extern void attacks_init(AttacksBackend backend);
+
+extern const char* attacks_backend_name_get(void);
+
+#ifndef TABLES_GENERATED
 
 extern void masks_init(void);
 
 extern void relevant_bits_init(void);
 
+#endif // TABLES_GENERATED
+
+
+extern U64 attacks_bishop_cover_get(Square square, U64 cover);
+
+extern U64 attacks_rook_cover_get  (Square square, U64 cover);
+
+extern U64 attacks_queen_cover_get (Square square, U64 cover);
+
 
 extern U64 attacks_bishop_get(Square square, Position position);
 
@@ -1,11 +1,14 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
 
+// The lines are generated at build time instead
+#ifndef TABLES_GENERATED
+
 U64 BOARD_LINES[BOARD_SQUARES][BOARD_SQUARES];
 
 /*
@@ -83,11 +86,36 @@ void board_lines_init(void)
   }
 }
 
+#endif // TABLES_GENERATED
+
 /*
+ * The bit functions are compiled once for the CPU the build targets,
+ * ex: make DEFINE_FLAGS=-march=native uses POPCNT and TZCNT directly.
  *
+ * Otherwise a clone with the instruction and a default clone is compiled,
+ * and the best clone for the running CPU is picked when the program loads
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__POPCNT__)
+#define POPCNT_TARGET_CLONES __attribute__((target_clones("popcnt", "default")))
+#else
+#define POPCNT_TARGET_CLONES
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__BMI__)
+#define TZCNT_TARGET_CLONES __attribute__((target_clones("bmi", "default")))
+#else
+#define TZCNT_TARGET_CLONES
+#endif
+
+/*
+ * Count the number of set bits in the board
  */
+POPCNT_TARGET_CLONES
 int board_bit_amount_get(U64 bitboard)
 {
+#ifdef __GNUC__
+  return __builtin_popcountll(bitboard);
+#else
   int amount;
 
   for(amount = 0; bitboard; amount++)
@@ -96,26 +124,75 @@ int board_bit_amount_get(U64 bitboard)
   }
 
   return amount;
+#endif
 }
 
 /*
+ * Get the square of the lowest set bit in the board
  *
+ * RETURN (Square square)
+ * - SQUARE_NONE | The board is empty
  */
+TZCNT_TARGET_CLONES
 Square board_first_square_get(U64 bitboard)
 {
   if(!bitboard) return SQUARE_NONE;
 
+#ifdef __GNUC__
+  return __builtin_ctzll(bitboard);
+#else
   return board_bit_amount_get((bitboard & -bitboard) - 1);
+#endif
+}
+
+/*
+ * Get the square of the lowest set bit in the board,
+ * and remove the bit from the board
+ *
+ * This is the inner step of every loop over the squares of a board
+ *
+ * RETURN (Square square)
+ * - SQUARE_NONE | The board is empty
+ */
+TZCNT_TARGET_CLONES
+Square board_first_square_pop(U64* bitboard)
+{
+  if(!*bitboard) return SQUARE_NONE;
+
+#ifdef __GNUC__
+  Square square = __builtin_ctzll(*bitboard);
+#else
+  Square square = board_bit_amount_get((*bitboard & -*bitboard) - 1);
+#endif
+
+  *bitboard &= *bitboard - 1;
+
+  return square;
 }
 
 /*
  * Get the piece that is on the specified square
+ *
+ * The side board tells the side of the piece,
+ * so only the 6 type boards have to be searched
  */
-Piece square_piece_get(U64 boards[12], Square square)
+Piece square_piece_get(Position position, Square square)
 {
-  for(Piece piece = PIECE_WHITE_PAWN; piece <= PIECE_BLACK_KING; piece++)
+  Side side;
+
+  if(BOARD_SQUARE_GET(position.sides[SIDE_WHITE], square))
+  {
+    side = SIDE_WHITE;
+  }
+  else if(BOARD_SQUARE_GET(position.sides[SIDE_BLACK], square))
+  {
+    side = SIDE_BLACK;
+  }
+  else return PIECE_NONE;
+
+  for(PieceType type = PIECE_TYPE_PAWN; type <= PIECE_TYPE_KING; type++)
   {
-    if(BOARD_SQUARE_GET(boards[piece], square)) return piece;
+    if(BOARD_SQUARE_GET(position.types[type], square)) return PIECE_CREATE(type, side);
   }
 
   return PIECE_NONE;
@@ -0,0 +1,134 @@
+/*
+ * Pack a position into 32 bytes, and unpack it again
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+/*
+ * Check that the passant square is behind a pawn that did a double jump
+ */
+static bool packed_passant_is_valid(Square passant)
+{
+  return passant == SQUARE_NONE || (passant >= A6 && passant <= H6) || (passant >= A3 && passant <= H3);
+}
+
+/*
+ * Check that every side has exactly one king
+ */
+static bool packed_kings_are_valid(const Position* position)
+{
+  U64 kings = position->types[PIECE_TYPE_KING];
+
+  return board_bit_amount_get(kings & position->sides[SIDE_WHITE]) == 1 &&
+         board_bit_amount_get(kings & position->sides[SIDE_BLACK]) == 1;
+}
+
+/*
+ * Pack the position, without a score or a result
+ *
+ * The clock is stored in one byte, so a larger clock is capped,
+ * which does not matter after 100 plies
+ *
+ * The position is checked like position_unpack does,
+ * so that every packed position can be unpacked again
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The position has more than 32 pieces
+ * - 3 | Bad passant square
+ * - 4 | Not one king per side
+ */
+int position_pack(PackedPosition* packed, Position position)
+{
+  U64 occupancy = POSITION_COVER_GET(position, SIDE_BOTH);
+
+  if(board_bit_amount_get(occupancy) > 32) return 1;
+
+  if(!packed_passant_is_valid(position.passant)) return 3;
+
+  if(!packed_kings_are_valid(&position)) return 4;
+
+  memset(packed, 0, sizeof(PackedPosition));
+
+  packed->occupancy = occupancy;
+
+  for(int index = 0; occupancy; index++)
+  {
+    Square square = board_first_square_pop(&occupancy);
+
+    Piece piece = square_piece_get(position, square);
+
+    packed->pieces[index / 2] |= (piece << ((index % 2) * 4));
+  }
+
+  packed->flags   = (position.side & 1) | ((position.castle & 0xf) << 1);
+  packed->passant = position.passant;
+  packed->clock   = (position.clock < 255) ? position.clock : 255;
+  packed->result  = PACKED_RESULT_NONE;
+  packed->score   = 0;
+  packed->turns   = position.turns;
+
+  return 0;
+}
+
+/*
+ * Unpack the position, the score and the result are left in the packed position
+ *
+ * The packed position can come from a corrupt file,
+ * so every part is checked before it is used
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | More than 32 pieces
+ * - 2 | Bad piece code
+ * - 3 | Bad flags or passant square
+ * - 4 | Not one king per side
+ */
+int position_unpack(Position* position, const PackedPosition* packed)
+{
+  U64 occupancy = packed->occupancy;
+
+  if(board_bit_amount_get(occupancy) > 32) return 1;
+
+  if(packed->flags > 0x1f) return 3;
+
+  Square passant = packed->passant;
+
+  if(!packed_passant_is_valid(passant)) return 3;
+
+  Position temp_position;
+
+  memset(temp_position.types, 0, sizeof(temp_position.types));
+  memset(temp_position.sides, 0, sizeof(temp_position.sides));
+
+  for(int index = 0; occupancy; index++)
+  {
+    Square square = board_first_square_pop(&occupancy);
+
+    Piece piece = (packed->pieces[index / 2] >> ((index % 2) * 4)) & 0xf;
+
+    if(piece >= PIECE_NONE) return 2;
+
+    PieceType type = PIECE_TYPE_GET(piece);
+    Side      side = PIECE_SIDE_GET(piece);
+
+    temp_position.types[type] = BOARD_SQUARE_SET(temp_position.types[type], square);
+    temp_position.sides[side] = BOARD_SQUARE_SET(temp_position.sides[side], square);
+  }
+
+  if(!packed_kings_are_valid(&temp_position)) return 4;
+
+  temp_position.side    = packed->flags & 1;
+  temp_position.castle  = (packed->flags >> 1) & 0xf;
+  temp_position.passant = passant;
+  temp_position.clock   = packed->clock;
+  temp_position.turns   = packed->turns;
+
+  *position = temp_position;
+
+  return 0;
+}
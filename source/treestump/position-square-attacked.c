@@ -3,108 +3,104 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
 
 /*
+ * Get the pieces of both sides that attack the square
  *
+ * The attacks are looked up from the square, with the supplied cover,
+ * so the cover can differ from the cover of the position,
+ * ex: without the king, to see the squares behind it
+ *
+ * RETURN (U64 board)
+ * - The squares of the attacking pieces
  */
-static bool square_is_attacked_by_queen(Position position, Square square, Side side)
+U64 square_attackers_get(const Position* position, Square square, U64 cover)
 {
-  U64 attacks = attacks_queen_get(square, position);
+  const U64* types = position->types;
 
-  U64 board = (side == SIDE_WHITE) ?
-              position.boards[PIECE_WHITE_QUEEN] :
-              position.boards[PIECE_BLACK_QUEEN];
+  U64 attackers = 0ULL;
 
-  return (attacks & board);
-}
+  // A white pawn attacks the square from where a black pawn would be attacked
+  attackers |= attacks_pawn_get(square, SIDE_BLACK) & types[PIECE_TYPE_PAWN] & position->sides[SIDE_WHITE];
+  attackers |= attacks_pawn_get(square, SIDE_WHITE) & types[PIECE_TYPE_PAWN] & position->sides[SIDE_BLACK];
 
-/*
- *
- */
-static bool square_is_attacked_by_bishop(Position position, Square square, Side side)
-{
-  U64 attacks = attacks_bishop_get(square, position);
+  attackers |= attacks_knight_get(square) & types[PIECE_TYPE_KNIGHT];
+
+  attackers |= attacks_king_get(square) & types[PIECE_TYPE_KING];
+
+  attackers |= attacks_bishop_cover_get(square, cover) & (types[PIECE_TYPE_BISHOP] | types[PIECE_TYPE_QUEEN]);
 
-  U64 board = (side == SIDE_WHITE) ?
-              position.boards[PIECE_WHITE_BISHOP] :
-              position.boards[PIECE_BLACK_BISHOP];
+  attackers |= attacks_rook_cover_get(square, cover) & (types[PIECE_TYPE_ROOK] | types[PIECE_TYPE_QUEEN]);
 
-  return (attacks & board);
+  return attackers;
 }
 
 /*
- *
+ * Check if supplied square is attacked by the pieces of the supplied side
  */
-static bool square_is_attacked_by_rook(Position position, Square square, Side side)
+bool square_is_attacked(Position position, Square square, Side side)
 {
-  U64 attacks = attacks_rook_get(square, position);
+  U64 attackers = square_attackers_get(&position, square, POSITION_COVER_GET(position, SIDE_BOTH));
 
-  U64 board = (side == SIDE_WHITE) ?
-              position.boards[PIECE_WHITE_ROOK] :
-              position.boards[PIECE_BLACK_ROOK];
-
-  return (attacks & board);
+  return (attackers & position.sides[side]);
 }
 
 /*
- *
+ * Check if any square of the board is attacked by the pieces of the supplied side
  */
-static bool square_is_attacked_by_pawn(Position position, Square square, Side side)
+bool board_is_attacked(const Position* position, U64 board, Side side)
 {
-  U64 attacks = (side == SIDE_WHITE) ?
-                attacks_pawn_get(square, SIDE_BLACK) :
-                attacks_pawn_get(square, SIDE_WHITE);
+  U64 cover = POSITION_COVER_GET(*position, SIDE_BOTH);
 
-  U64 board = (side == SIDE_WHITE) ?
-              position.boards[PIECE_WHITE_PAWN] :
-              position.boards[PIECE_BLACK_PAWN];
+  while(board)
+  {
+    Square square = board_first_square_pop(&board);
 
-  return (attacks & board);
+    if(square_attackers_get(position, square, cover) & position->sides[side]) return true;
+  }
+
+  return false;
 }
 
 /*
+ * Get all the squares that the pieces of the supplied side attack
+ *
+ * The sliders are looked up with the supplied cover,
+ * ex: without the king of the other side
  *
+ * RETURN (U64 board)
  */
-static bool square_is_attacked_by_king(Position position, Square square, Side side)
+U64 side_attacks_get(const Position* position, Side side, U64 cover)
 {
-  U64 attacks = attacks_king_get(square);
+  const U64* types = position->types;
 
-  U64 board = (side == SIDE_WHITE) ?
-              position.boards[PIECE_WHITE_KING] :
-              position.boards[PIECE_BLACK_KING];
+  U64 pieces = position->sides[side];
 
-  return (attacks & board);
-}
+  U64 attacks = 0ULL;
 
-/*
- *
- */
-static bool square_is_attacked_by_knight(Position position, Square square, Side side)
-{
-  U64 attacks = attacks_knight_get(square);
+  U64 board = types[PIECE_TYPE_PAWN] & pieces;
 
-  U64 board = (side == SIDE_WHITE) ?
-              position.boards[PIECE_WHITE_KNIGHT] :
-              position.boards[PIECE_BLACK_KNIGHT];
+  while(board) attacks |= attacks_pawn_get(board_first_square_pop(&board), side);
 
-  return (attacks & board);
-}
+  board = types[PIECE_TYPE_KNIGHT] & pieces;
 
-/*
- * Check if supplied square is attacked by oponent side pieces
- *
- * Next: Add side back to functions
- */
-bool square_is_attacked(Position position, Square square, Side side)
-{
-  return (square_is_attacked_by_queen( position, square, side) ||
-          square_is_attacked_by_rook(  position, square, side) ||
-          square_is_attacked_by_bishop(position, square, side) ||
-          square_is_attacked_by_pawn(  position, square, side) ||
-          square_is_attacked_by_king(  position, square, side) ||
-          square_is_attacked_by_knight(position, square, side));
+  while(board) attacks |= attacks_knight_get(board_first_square_pop(&board));
+
+  board = (types[PIECE_TYPE_BISHOP] | types[PIECE_TYPE_QUEEN]) & pieces;
+
+  while(board) attacks |= attacks_bishop_cover_get(board_first_square_pop(&board), cover);
+
+  board = (types[PIECE_TYPE_ROOK] | types[PIECE_TYPE_QUEEN]) & pieces;
+
+  while(board) attacks |= attacks_rook_cover_get(board_first_square_pop(&board), cover);
+
+  board = types[PIECE_TYPE_KING] & pieces;
+
+  while(board) attacks |= attacks_king_get(board_first_square_pop(&board));
+
+  return attacks;
 }
@@ -1,7 +1,7 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #ifndef POSITION_H
@@ -9,20 +9,69 @@
 
 #include "../treestump.h"
 
+/*
+ * The result of the game that a packed position is from
+ */
+typedef enum
+{
+  PACKED_RESULT_BLACK,
+  PACKED_RESULT_DRAW,
+  PACKED_RESULT_WHITE,
+  PACKED_RESULT_NONE
+} PackedResult;
+
+/*
+ * A position packed into 32 bytes, for datasets
+ *
+ * The pieces are 4 bit piece codes, two per byte,
+ * in the order of the squares in the occupancy board
+ *
+ * flags | The side to move in bit 0, and the castle rights in bit 1-4
+ * score | An optional score of the position, from the view of white
+ */
+typedef struct
+{
+  U64      occupancy;
+  uint8_t  pieces[16];
+  uint8_t  flags;
+  uint8_t  passant;
+  uint8_t  clock;
+  uint8_t  result;
+  int16_t  score;
+  uint16_t turns;
+} PackedPosition;
+
+#ifndef TABLES_GENERATED
+
 extern void board_lines_init(void);
 
+#endif // TABLES_GENERATED
+
 
 extern int    board_bit_amount_get(U64 bitboard);
 
 extern Square board_first_square_get(U64 bitboard);
 
+extern Square board_first_square_pop(U64* bitboard);
+
 
 extern void position_print(Position position);
 
 
-extern Piece square_piece_get(U64 boards[12], Square square);
+extern Piece square_piece_get(Position position, Square square);
+
+
+extern int  position_pack(PackedPosition* packed, Position position);
 
+extern int  position_unpack(Position* position, const PackedPosition* packed);
+
+
+extern U64  square_attackers_get(const Position* position, Square square, U64 cover);
 
 extern bool square_is_attacked(Position position, Square square, Side side);
 
+extern bool board_is_attacked(const Position* position, U64 board, Side side);
+
+extern U64  side_attacks_get(const Position* position, Side side, U64 cover);
+
 #endif // POSITION_H
@@ -0,0 +1,97 @@
+/*
+ * Create the fen string of a position
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "uci-intern.h"
+
+/*
+ * Create the board part of the fen, rank by rank
+ *
+ * RETURN (char* end)
+ * - The end of the board part in the string
+ */
+static char* fen_boards_create(char* string, Position position)
+{
+  for(int rank = 0; rank < BOARD_RANKS; rank++)
+  {
+    int empty = 0;
+
+    for(int file = 0; file < BOARD_FILES; file++)
+    {
+      Piece piece = square_piece_get(position, (rank * BOARD_FILES) + file);
+
+      if(piece == PIECE_NONE)
+      {
+        empty++;
+
+        continue;
+      }
+
+      if(empty > 0) *string++ = '0' + empty;
+
+      empty = 0;
+
+      *string++ = PIECE_SYMBOLS[piece];
+    }
+
+    if(empty > 0) *string++ = '0' + empty;
+
+    if(rank < (BOARD_RANKS - 1)) *string++ = '/';
+  }
+
+  return string;
+}
+
+/*
+ * Create the castle part of the fen
+ *
+ * RETURN (char* end)
+ * - The end of the castle part in the string
+ */
+static char* fen_castle_create(char* string, Castle castle)
+{
+  if(!castle)
+  {
+    *string++ = '-';
+
+    return string;
+  }
+
+  if(castle & CASTLE_WHITE_KING)  *string++ = 'K';
+  if(castle & CASTLE_WHITE_QUEEN) *string++ = 'Q';
+  if(castle & CASTLE_BLACK_KING)  *string++ = 'k';
+  if(castle & CASTLE_BLACK_QUEEN) *string++ = 'q';
+
+  return string;
+}
+
+/*
+ * Create the fen string of the position
+ *
+ * PARAMS
+ * - char* string | Buffer for the fen, FEN_STRING_SIZE is large enough
+ *
+ * RETURN (char* string)
+ */
+char* fen_create(char* string, Position position)
+{
+  char* end = fen_boards_create(string, position);
+
+  *end++ = ' ';
+  *end++ = SIDE_SYMBOLS[position.side];
+  *end++ = ' ';
+
+  end = fen_castle_create(end, position.castle);
+
+  const char* passant = (position.passant != SQUARE_NONE) ? SQUARE_STRINGS[position.passant] : "-";
+
+  sprintf(end, " %s %d %d", passant, position.clock, position.turns);
+
+  return string;
+}
@@ -0,0 +1,267 @@
+/*
+ * Load a file of fen strings, one per line, into an array of positions
+ *
+ * The file is read at once, and the lines are parsed by several threads,
+ * every thread parsing its own range of lines into its own range of positions
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+ * A range of lines that one thread parses
+ *
+ * The positions that parsed are put first in the range,
+ * with the file line numbers of their lines, and amount is how many they are
+ */
+typedef struct
+{
+  char**        lines;
+  const size_t* numbers;
+  Position*     positions;
+  size_t*       line_numbers;
+  size_t        start;
+  size_t        stop;
+  size_t        amount;
+} FenRange;
+
+/*
+ * Parse the lines of the range, skipping the lines that fail to parse
+ */
+static void* fen_range_parse(void* data)
+{
+  FenRange* range = data;
+
+  range->amount = 0;
+
+  for(size_t index = range->start; index < range->stop; index++)
+  {
+    Position* position = &range->positions[range->start + range->amount];
+
+    if(fen_parse(position, range->lines[index]) != 0) continue;
+
+    range->line_numbers[range->start + range->amount] = range->numbers[index];
+
+    range->amount++;
+  }
+
+  return NULL;
+}
+
+/*
+ * Read the whole file into a string, that ends with a null character
+ *
+ * RETURN (char* string)
+ * - NULL | Failed to read the file
+ */
+static char* file_string_read(const char* filepath, size_t* size)
+{
+  FILE* file = fopen(filepath, "rb");
+
+  if(!file) return NULL;
+
+  fseek(file, 0, SEEK_END);
+
+  long length = ftell(file);
+
+  fseek(file, 0, SEEK_SET);
+
+  char* string = (length >= 0) ? malloc(length + 1) : NULL;
+
+  if(!string || fread(string, 1, length, file) != (size_t) length)
+  {
+    if(string) free(string);
+
+    fclose(file);
+
+    return NULL;
+  }
+
+  string[length] = '\0';
+
+  *size = length;
+
+  fclose(file);
+
+  return string;
+}
+
+/*
+ * Split the string into lines, by putting a null character at every line end
+ *
+ * Empty lines are skipped, and a carriage return is removed.
+ * The file line number of every line, counted from 1, is put in numbers
+ *
+ * RETURN (char** lines)
+ * - NULL | Failed to allocate the lines
+ */
+static char** string_lines_split(char* string, size_t size, size_t* amount, size_t** numbers)
+{
+  size_t lineAmount = 1;
+
+  for(char* symbol = string; (symbol = memchr(symbol, '\n', size - (symbol - string))); symbol++)
+  {
+    lineAmount++;
+  }
+
+  char** lines = malloc(lineAmount * sizeof(char*));
+
+  *numbers = malloc(lineAmount * sizeof(size_t));
+
+  if(!lines || !*numbers)
+  {
+    if(lines) free(lines);
+
+    if(*numbers) free(*numbers);
+
+    return NULL;
+  }
+
+  *amount = 0;
+
+  char* line = string;
+
+  for(size_t number = 1; line < string + size; number++)
+  {
+    char* end = memchr(line, '\n', size - (line - string));
+
+    if(!end) end = string + size;
+
+    *end = '\0';
+
+    if(end > line && end[-1] == '\r') end[-1] = '\0';
+
+    if(*line != '\0')
+    {
+      (*numbers)[*amount] = number;
+
+      lines[(*amount)++] = line;
+    }
+
+    line = end + 1;
+  }
+
+  return lines;
+}
+
+/*
+ * Load every fen in the file into a contiguous array of positions
+ *
+ * PARAMS
+ * - const char* filepath      | File with one fen per line
+ * - size_t*     amount        | The amount of loaded positions
+ * - size_t**    line_numbers  | The file line numbers of the positions, or NULL
+ * - int         thread_amount | Threads to parse with, or 0 for every processor
+ *
+ * Lines that fail to parse are skipped, so the line numbers
+ * are how the positions are matched to the lines of the file
+ *
+ * RETURN (Position* positions)
+ * - NULL | Failed to read the file, or to allocate memory
+ */
+Position* fens_file_load(const char* filepath, size_t* amount, size_t** line_numbers, int thread_amount)
+{
+  size_t size = 0;
+
+  char* string = file_string_read(filepath, &size);
+
+  if(!string)
+  {
+    if(args.debug) error_print("Failed to read fen file: %s", filepath);
+
+    return NULL;
+  }
+
+  size_t lineAmount = 0;
+
+  size_t* numbers = NULL;
+
+  char** lines = string_lines_split(string, size, &lineAmount, &numbers);
+
+  Position* positions = lines ? malloc((lineAmount + 1) * sizeof(Position)) : NULL;
+
+  size_t* positionNumbers = positions ? malloc((lineAmount + 1) * sizeof(size_t)) : NULL;
+
+  if(!positionNumbers)
+  {
+    if(positions) free(positions);
+
+    if(lines)
+    {
+      free(numbers);
+
+      free(lines);
+    }
+
+    free(string);
+
+    return NULL;
+  }
+
+  if(thread_amount <= 0) thread_amount = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if(thread_amount <= 0) thread_amount = 1;
+
+  if(thread_amount > lineAmount) thread_amount = (lineAmount > 0) ? lineAmount : 1;
+
+  FenRange  ranges[thread_amount];
+  pthread_t threads[thread_amount];
+
+  for(int index = 0; index < thread_amount; index++)
+  {
+    ranges[index] = (FenRange)
+    {
+      .lines        = lines,
+      .numbers      = numbers,
+      .positions    = positions,
+      .line_numbers = positionNumbers,
+      .start        = (lineAmount * index) / thread_amount,
+      .stop         = (lineAmount * (index + 1)) / thread_amount
+    };
+
+    // The range is parsed by this thread, if a thread can not be created
+    if(pthread_create(&threads[index], NULL, fen_range_parse, &ranges[index]) != 0)
+    {
+      fen_range_parse(&ranges[index]);
+
+      threads[index] = pthread_self();
+    }
+  }
+
+  *amount = 0;
+
+  for(int index = 0; index < thread_amount; index++)
+  {
+    if(!pthread_equal(threads[index], pthread_self())) pthread_join(threads[index], NULL);
+
+    // Move the parsed positions of the range after the ranges before it
+    memmove(&positions[*amount], &positions[ranges[index].start], ranges[index].amount * sizeof(Position));
+
+    memmove(&positionNumbers[*amount], &positionNumbers[ranges[index].start], ranges[index].amount * sizeof(size_t));
+
+    *amount += ranges[index].amount;
+  }
+
+  if(args.debug && *amount < lineAmount)
+  {
+    error_print("Skipped %ld lines that failed to parse", (long) (lineAmount - *amount));
+  }
+
+  if(line_numbers) *line_numbers = positionNumbers;
+
+  else free(positionNumbers);
+
+  free(numbers);
+
+  free(lines);
+
+  free(string);
+
+  return positions;
+}
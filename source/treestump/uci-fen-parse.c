@@ -1,7 +1,12 @@
 /*
+ * Parse a fen string in one pass, without allocating memory
+ *
+ * Every part parser moves the string past its part,
+ * so the next part starts after the spaces between them
+ *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
@@ -9,135 +14,120 @@
 #include "uci-intern.h"
 
 /*
- * Split a string at deliminator into multiple smaller string parts
- *
- * PARAMS
- * - char** string_array | array to store splitted strings to
- *   - the array should be allocated with size >= split_amount
- *
- * RETURN (size_t count)
- * - number of strings successfully splitted
+ * Check if the character ends a part of the fen
+ */
+static bool fen_part_is_end(char symbol)
+{
+  return (symbol == ' ' || symbol == '\0');
+}
+
+/*
+ * Move the string past the spaces before the next part
  */
-static size_t string_split_at_delim(char** string_array, const char* string, const char* delim, size_t split_amount)
+static void fen_spaces_skip(const char** string)
 {
-  if(!string_array || !string)
+  while(**string == ' ') (*string)++;
+}
+
+/*
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Unknown symbol
+ * - 2 | Too many squares in a rank
+ * - 3 | Wrong amount of ranks or files
+ */
+static int fen_boards_parse(Position* position, const char** string)
+{
+  memset(position->types, 0ULL, sizeof(position->types));
+  memset(position->sides, 0ULL, sizeof(position->sides));
+
+  int rank = 0;
+  int file = 0;
+
+  for(; !fen_part_is_end(**string); (*string)++)
   {
-    if(args.debug) error_print("String array or string not allocated");
+    char symbol = **string;
 
-    return 0;
-  }
+    if(symbol == '/')
+    {
+      if(file != BOARD_FILES || ++rank >= BOARD_RANKS) return 3;
+
+      file = 0;
+    }
+    else if(symbol >= '1' && symbol <= '8')
+    {
+      file += (symbol - '0');
+    }
+    else if(memchr(PIECE_SYMBOLS, symbol, sizeof(PIECE_SYMBOLS)))
+    {
+      if(file >= BOARD_FILES) return 2;
 
-  if(split_amount <= 0) return 0;
+      Square square = (rank * BOARD_FILES) + file;
 
-  char string_copy[strlen(string) + 1]; 
-  strcpy(string_copy, string);
+      Piece piece = SYMBOL_PIECES[(unsigned char) symbol];
 
-  char* string_token = NULL;
-  
-  string_token = strtok(string_copy, delim);
+      PieceType type = PIECE_TYPE_GET(piece);
+      Side      side = PIECE_SIDE_GET(piece);
 
-  size_t index;
+      position->types[type] = BOARD_SQUARE_SET(position->types[type], square);
+      position->sides[side] = BOARD_SQUARE_SET(position->sides[side], square);
 
-  for(index = 0; (index < split_amount) && string_token; index++)
-  {
-    string_array[index] = strdup(string_token);
+      file++;
+    }
+    else
+    {
+      if(args.debug) error_print("Unknown fen symbol: (%c)", symbol);
+
+      return 1;
+    }
 
-    string_token = strtok(NULL, delim);
+    if(file > BOARD_FILES) return 2;
   }
 
-  return index;
+  return (rank == (BOARD_RANKS - 1) && file == BOARD_FILES) ? 0 : 3;
 }
 
 /*
  *
  */
-static int fen_side_parse(Side* side, const char* string)
+static int fen_side_parse(Side* side, const char** string)
 {
-  if(strlen(string) != 1) return 1;
-
-  switch(*string)
+  switch(**string)
   {
     case 'w':
       *side = SIDE_WHITE;
-      return 0;
+      break;
 
     case 'b':
       *side = SIDE_BLACK;
-      return 0;
+      break;
 
     default:
       return 2;
   }
-}
-
-/*
- *
- */
-static int fen_clock_parse(int* clock, const char* string)
-{
-  int number = atoi(string);
 
-  if((number == 0) && (*string != '0')) return 1;
+  (*string)++;
 
-  *clock = number;
-
-  return 0;
+  return fen_part_is_end(**string) ? 0 : 1;
 }
 
 /*
  *
  */
-static int fen_turns_parse(int* turns, const char* string)
+static int fen_castle_parse(Castle* castle, const char** string)
 {
-  int number = atoi(string);
+  *castle = 0;
 
-  if((number == 0) && (*string != '0')) return 1;
-
-  *turns = number;
-
-  return 0;
-}
-
-/*
- *
- */
-static int fen_passant_parse(Square* passant, const char* string)
-{
-  if(strcmp(string, "-") == 0)
+  if(**string == '-')
   {
-    *passant = SQUARE_NONE;
-    
-    return 0;
-  }
+    (*string)++;
 
-  if(strlen(string) != 2) return 1;
-
-
-  int file = string[0] - 'a';
-  int rank = BOARD_RANKS - (string[1] - '0');
-
-  if(!(file >= 0 && file < BOARD_FILES) || !(rank >= 0 && rank < BOARD_RANKS))
-  {
-    return 2;
+    return fen_part_is_end(**string) ? 0 : 1;
   }
 
-  *passant = (rank * BOARD_FILES) + file;
-
-  return 0;
-}
-
-/*
- *
- */
-static int fen_castle_parse(Castle* castle, const char* string)
-{
-  if(strcmp(string, "-") == 0) return 0;
-
-  size_t string_len = strlen(string);
-
-  for(size_t index = 0; index < string_len; index++)
+  for(; !fen_part_is_end(**string); (*string)++)
   {
-    switch(string[index])
+    switch(**string)
     {
       case 'K':
         *castle |= CASTLE_WHITE_KING;
@@ -166,208 +156,135 @@ static int fen_castle_parse(Castle* castle, const char* string)
 /*
  *
  */
-static void string_array_free(char** string_array, size_t string_count)
+static int fen_passant_parse(Square* passant, const char** string)
 {
-  if(!string_array) return;
+  const char* part = *string;
 
-  for(size_t index = 0; index < string_count; index++)
+  if(part[0] == '-' && fen_part_is_end(part[1]))
   {
-    if(string_array[index]) free(string_array[index]);
-  }
-}
+    *passant = SQUARE_NONE;
 
-/*
- * RETURN (int status)
- * - 0 | Success
- * - 1 | Failed to split fen board
- */
-static int fen_boards_parse(U64 boards[12], const char string[])
-{
-  memset(boards, 0ULL, sizeof(U64) * 12);
+    *string += 1;
 
-  char* string_array[8];
+    return 0;
+  }
 
-  size_t split_count = 0;
+  int file = part[0] - 'a';
+  int rank = BOARD_RANKS - (part[1] - '0');
 
-  if((split_count = string_split_at_delim(string_array, string, "/", BOARD_RANKS)) < BOARD_RANKS)
+  if(!(file >= 0 && file < BOARD_FILES) || !(rank >= 0 && rank < BOARD_RANKS))
   {
-    if(args.debug) error_print("Failed to split fen board string");
-
-    string_array_free(string_array, split_count);
-
-    return 1;
+    return 2;
   }
 
-  for(int rank = 0; rank < BOARD_RANKS; rank++)
-  {
-    char*  rank_string        = string_array[rank];
-    size_t rank_string_length = strlen(rank_string);
-
-    // Future Fix: check if rank length is less or equal to 8
-    // and if there is any symbols that should not be in fen string
-    int file = 0;
-
-    for(int index = 0; index < rank_string_length; index++)
-    {
-      char symbol = rank_string[index];
-
+  if(!fen_part_is_end(part[2])) return 1;
 
-      Square square = (rank * BOARD_FILES) + file;
-
-      if((symbol >= 'A' && symbol <= 'Z') || (symbol >= 'a' && symbol <= 'z'))
-      {
-        Piece piece = SYMBOL_PIECES[symbol];
-
-        boards[piece] = BOARD_SQUARE_SET(boards[piece], square);
-
-        file++;
-      }
-      else if(symbol >= '0' && symbol <= '9')
-      {
-        file += (symbol - '0');
-      }
-      else
-      {
-        if(args.debug) error_print("Unknown fen symbol: (%c)", symbol);
-      }
-    }
-  }
+  *passant = (rank * BOARD_FILES) + file;
 
-  string_array_free(string_array, split_count);
+  *string += 2;
 
   return 0;
 }
 
 /*
+ * Parse a number part, like the clock and the turns
+ *
  * RETURN (int status)
  * - 0 | Success
- * - 1 | Failed to parse fen board
- * - 2 | Failed to parse fen side
- * - 3 | Failed to parse fen castle
- * - 4 | Failed to parse fen enpassant
- * - 5 | Failed to parse fen clock
- * - 6 | Failed to parse fen turns
- * - 7 | Invalid index
+ * - 1 | The part is not a number
  */
-static int fen_index_part_parse(Position* position, int index, const char* string)
+static int fen_number_parse(int* number, const char** string)
 {
-  switch(index)
-  {
-    case 0:
-      if(fen_boards_parse(position->boards, string) != 0)
-      {
-        if(args.debug) error_print("Failed to parse fen board");
+  const char* part = *string;
 
-        return 1;
-      }
-      return 0;
-
-    case 1:
-      if(fen_side_parse(&position->side, string) != 0)
-      {
-        if(args.debug) error_print("Failed to parse fen side");
-
-        return 2;
-      }
-      return 0;
-
-    case 2:
-      if(fen_castle_parse(&position->castle, string) != 0)
-      {
-        if(args.debug) error_print("Failed to parse fen castle");
-
-        return 3;
-      }
-      return 0;
-
-    case 3:
-      if(fen_passant_parse(&position->passant, string) != 0)
-      {
-        if(args.debug) error_print("Failed to parse fen passant");
-
-        return 4;
-      }
-      return 0;
-
-    case 4:
-      if(fen_clock_parse(&position->clock, string) != 0)
-      {
-        if(args.debug) error_print("Failed to parse fen clock");
-
-        return 5;
-      }
-      return 0;
-
-    case 5:
-      if(fen_turns_parse(&position->turns, string) != 0)
-      {
-        if(args.debug) error_print("Failed to parse fen turns");
-
-        return 6;
-      }
-      return 0;
+  int value = 0;
 
-    default:
-      return 7;
+  for(; *part >= '0' && *part <= '9'; part++)
+  {
+    value = (value * 10) + (*part - '0');
   }
+
+  if(part == *string || !fen_part_is_end(*part)) return 1;
+
+  *number = value;
+
+  *string = part;
+
+  return 0;
 }
 
 /*
  * Parse fen string
  *
+ * The clock and the turns can be left out, like in an epd string,
+ * then the clock is 0 and the turns are 1
+ *
  * RETURN (int status)
  * - 0 | Success
- * - 1 | Failed to split fen string
+ * - 1 | Failed to parse fen board
+ * - 2 | Failed to parse fen side
+ * - 3 | Failed to parse fen castle
+ * - 4 | Failed to parse fen passant
  */
 int fen_parse(Position* position, const char* fen_string)
 {
   if(args.debug) info_print("Parsing fen (%s)", fen_string);
 
-  char* string_array[6];
+  Position temp_position;
 
-  size_t split_count = 0;
+  const char* string = fen_string;
 
-  if((split_count = string_split_at_delim(string_array, fen_string, " ", 6)) < 4)
-  {
-    if(args.debug) error_print("Failed to split fen string");
+  fen_spaces_skip(&string);
 
-    string_array_free(string_array, split_count);
+  if(fen_boards_parse(&temp_position, &string) != 0)
+  {
+    if(args.debug) error_print("Failed to parse fen board");
 
     return 1;
   }
 
-  Position temp_position;
+  fen_spaces_skip(&string);
 
-  for(int index = 0; index < split_count; index++)
+  if(fen_side_parse(&temp_position.side, &string) != 0)
   {
-    if(fen_index_part_parse(&temp_position, index, string_array[index]) != 0)
-    {
-      string_array_free(string_array, split_count);
+    if(args.debug) error_print("Failed to parse fen side");
 
-      return 2;
-    }
+    return 2;
   }
 
-  *position = temp_position;
-
-  string_array_free(string_array, split_count);
+  fen_spaces_skip(&string);
 
+  if(fen_castle_parse(&temp_position.castle, &string) != 0)
+  {
+    if(args.debug) error_print("Failed to parse fen castle");
 
-  memset(position->covers, 0ULL, sizeof(U64) * 3);
+    return 3;
+  }
 
+  fen_spaces_skip(&string);
 
-  for(Piece piece = PIECE_WHITE_PAWN; piece <= PIECE_WHITE_KING; piece++)
+  if(fen_passant_parse(&temp_position.passant, &string) != 0)
   {
-    position->covers[SIDE_WHITE] |= position->boards[piece];
+    if(args.debug) error_print("Failed to parse fen passant");
+
+    return 4;
   }
 
-  for(Piece piece = PIECE_BLACK_PAWN; piece <= PIECE_BLACK_KING; piece++)
+  fen_spaces_skip(&string);
+
+  if(fen_number_parse(&temp_position.clock, &string) != 0)
   {
-    position->covers[SIDE_BLACK] |= position->boards[piece];
+    temp_position.clock = 0;
   }
 
-  position->covers[SIDE_BOTH] = position->covers[SIDE_WHITE] | position->covers[SIDE_BLACK];
+  fen_spaces_skip(&string);
 
+  if(fen_number_parse(&temp_position.turns, &string) != 0)
+  {
+    temp_position.turns = 1;
+  }
+
+  *position = temp_position;
 
   if(args.debug) info_print("Parsed fen");
 
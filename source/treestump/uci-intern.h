@@ -1,7 +1,7 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-10
+ * Last updated: 2026-10-19
  */
 
 #ifndef UCI_INTERN_H
@@ -17,4 +17,10 @@ extern const char* SQUARE_STRINGS[BOARD_SQUARES];
 
 extern const char PIECE_SYMBOLS[12];
 
+extern void uci_search_start(Position position, const KeyHistory* history, SearchLimits limits);
+
+extern void uci_search_stop(void);
+
+extern void uci_search_ponderhit(void);
+
 #endif // UCI_INTERN_H
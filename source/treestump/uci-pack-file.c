@@ -0,0 +1,324 @@
+/*
+ * Convert between fen files and packed position files,
+ * and read packed position files by mapping them into memory
+ *
+ * A line of a fen file can have a score and a result after the fen:
+ *
+ *   fen | score | result
+ *
+ * where the score is from the view of white, and the result is
+ * 1.0, 0.5 or 0.0 (or 1-0, 1/2-1/2 or 0-1), or - if it is unknown
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Parse the result of a fen line
+ */
+static PackedResult packed_result_parse(const char* string)
+{
+  while(*string == ' ') string++;
+
+  if(strncmp(string, "1.0", 3) == 0 || strncmp(string, "1-0", 3) == 0)
+  {
+    return PACKED_RESULT_WHITE;
+  }
+
+  if(strncmp(string, "0.5", 3) == 0 || strncmp(string, "1/2-1/2", 7) == 0)
+  {
+    return PACKED_RESULT_DRAW;
+  }
+
+  if(strncmp(string, "0.0", 3) == 0 || strncmp(string, "0-1", 3) == 0)
+  {
+    return PACKED_RESULT_BLACK;
+  }
+
+  return PACKED_RESULT_NONE;
+}
+
+/*
+ * Parse a fen line, with an optional score and result, into a packed position
+ *
+ * The line is changed, because the fen is ended where the score begins
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to parse the fen
+ * - 2 | Failed to pack the position
+ */
+static int packed_line_parse(PackedPosition* packed, char* line)
+{
+  char* scoreString = strchr(line, '|');
+
+  if(scoreString) *scoreString++ = '\0';
+
+  Position position;
+
+  if(fen_parse(&position, line) != 0) return 1;
+
+  if(position_pack(packed, position) != 0) return 2;
+
+  if(!scoreString) return 0;
+
+  packed->score = atoi(scoreString);
+
+  char* resultString = strchr(scoreString, '|');
+
+  if(resultString) packed->result = packed_result_parse(resultString + 1);
+
+  return 0;
+}
+
+/*
+ * Write the packed position as a fen line, with its score and result
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The packed position is bad
+ */
+static int packed_line_write(FILE* file, const PackedPosition* packed)
+{
+  static const char* RESULT_STRINGS[] = { "0.0", "0.5", "1.0", "-" };
+
+  Position position;
+
+  if(position_unpack(&position, packed) != 0) return 1;
+
+  char fenString[FEN_STRING_SIZE];
+  fen_create(fenString, position);
+
+  const char* resultString = RESULT_STRINGS[(packed->result <= PACKED_RESULT_NONE) ? packed->result : PACKED_RESULT_NONE];
+
+  fprintf(file, "%s | %d | %s\n", fenString, packed->score, resultString);
+
+  return 0;
+}
+
+/*
+ * Pack every fen line of the input file into the output file
+ *
+ * Lines that fail to parse, or that can not be unpacked again, are skipped
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open the input file
+ * - 2 | Failed to open the output file
+ * - 3 | Failed to write the output file
+ */
+int fens_file_pack(const char* input, const char* output)
+{
+  FILE* inputFile = fopen(input, "r");
+
+  if(!inputFile)
+  {
+    if(args.debug) error_print("Failed to open fen file: %s", input);
+
+    return 1;
+  }
+
+  FILE* outputFile = fopen(output, "wb");
+
+  if(!outputFile)
+  {
+    if(args.debug) error_print("Failed to open packed file: %s", output);
+
+    fclose(inputFile);
+
+    return 2;
+  }
+
+  char*  line = NULL;
+  size_t size = 0;
+
+  size_t amount  = 0;
+  size_t skipped = 0;
+
+  int status = 0;
+
+  while(getline(&line, &size, inputFile) >= 0)
+  {
+    line[strcspn(line, "\r\n")] = '\0';
+
+    if(line[0] == '\0') continue;
+
+    PackedPosition packed;
+
+    // Lines that can not be unpacked again are not written
+    if(packed_line_parse(&packed, line) != 0)
+    {
+      skipped++;
+
+      continue;
+    }
+
+    if(fwrite(&packed, sizeof(PackedPosition), 1, outputFile) != 1)
+    {
+      status = 3;
+
+      break;
+    }
+
+    amount++;
+  }
+
+  if(args.debug) info_print("Packed %ld positions", (long) amount);
+
+  if(args.debug && skipped > 0) error_print("Skipped %ld bad lines", (long) skipped);
+
+  free(line);
+
+  fclose(inputFile);
+
+  if(fclose(outputFile) != 0) status = 3;
+
+  return status;
+}
+
+/*
+ * Map the packed file into memory, without reading it
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open the file
+ * - 2 | The size of the file is not a multiple of the record size
+ * - 3 | Failed to map the file
+ */
+int packed_file_open(PackedFile* file, const char* filepath)
+{
+  int descriptor = open(filepath, O_RDONLY);
+
+  if(descriptor < 0)
+  {
+    if(args.debug) error_print("Failed to open packed file: %s", filepath);
+
+    return 1;
+  }
+
+  struct stat status;
+
+  if(fstat(descriptor, &status) != 0 || status.st_size % sizeof(PackedPosition) != 0)
+  {
+    if(args.debug) error_print("Bad size of packed file: %s", filepath);
+
+    close(descriptor);
+
+    return 2;
+  }
+
+  file->size   = status.st_size;
+  file->amount = status.st_size / sizeof(PackedPosition);
+
+  // An empty file can not be mapped, but it is still a valid file
+  if(file->size == 0)
+  {
+    file->records = NULL;
+
+    close(descriptor);
+
+    return 0;
+  }
+
+  void* memory = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+  // The mapping is kept after the file is closed
+  close(descriptor);
+
+  if(memory == MAP_FAILED)
+  {
+    if(args.debug) error_print("Failed to map packed file: %s", filepath);
+
+    return 3;
+  }
+
+  madvise(memory, file->size, MADV_SEQUENTIAL);
+
+  file->records = memory;
+
+  return 0;
+}
+
+/*
+ * Unmap the packed file
+ */
+void packed_file_close(PackedFile* file)
+{
+  if(file->records) munmap((void*) file->records, file->size);
+
+  file->records = NULL;
+  file->amount  = 0;
+  file->size    = 0;
+}
+
+/*
+ * Decode a record of the packed file into a position
+ *
+ * RETURN (const PackedPosition* packed)
+ * - NULL | The index is outside of the file, or the record is bad
+ */
+const PackedPosition* packed_file_position_get(Position* position, const PackedFile* file, size_t index)
+{
+  if(index >= file->amount) return NULL;
+
+  const PackedPosition* packed = &file->records[index];
+
+  if(position_unpack(position, packed) != 0)
+  {
+    if(args.debug) error_print("Bad packed position: %ld", (long) index);
+
+    return NULL;
+  }
+
+  return packed;
+}
+
+/*
+ * Write every record of the packed file as a fen line,
+ * skipping the records that are bad
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open the input file
+ * - 2 | Failed to open the output file
+ */
+int packed_file_unpack(const char* input, const char* output)
+{
+  PackedFile packedFile;
+
+  if(packed_file_open(&packedFile, input) != 0) return 1;
+
+  FILE* file = output ? fopen(output, "w") : stdout;
+
+  if(!file)
+  {
+    if(args.debug) error_print("Failed to open output: %s", output);
+
+    packed_file_close(&packedFile);
+
+    return 2;
+  }
+
+  size_t badAmount = 0;
+
+  for(size_t index = 0; index < packedFile.amount; index++)
+  {
+    if(packed_line_write(file, &packedFile.records[index]) != 0) badAmount++;
+  }
+
+  if(args.debug && badAmount > 0) error_print("Skipped %ld bad packed positions", (long) badAmount);
+
+  if(file != stdout) fclose(file);
+
+  packed_file_close(&packedFile);
+
+  return 0;
+}
@@ -1,13 +1,26 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-09
+ * Last updated: 2026-10-19
  */
 
 #include "../treestump.h"
 
 #include "uci-intern.h"
 
+// The positions of the game before the current position
+static KeyHistory game_history = { .amount = 0 };
+
+// The amount of best lines to search, set by the MultiPV option
+static int uci_multipv = 1;
+
+// The opening book, set by the Book option
+static Book uci_book = { .entries = NULL, .amount = 0, .size = 0, .seed = 0 };
+
+// The last position command, that the position and the history are from
+static char*  last_position_string = NULL;
+static size_t last_position_size   = 0;
+
 /*
  *
  */
@@ -29,7 +42,7 @@ static MoveArray move_strings_parse(Position position, const char moves_string[]
 
     while(*moves_string && *moves_string != ' ') moves_string++;
 
-    moves_string++;
+    while(*moves_string == ' ') moves_string++;
   }
 
   return moveArray;
@@ -40,6 +53,8 @@ static MoveArray move_strings_parse(Position position, const char moves_string[]
  */
 static void uci_go_parse(Position position, const char goString[])
 {
+  uci_search_stop();
+
   if(!strncmp(goString, "perft", 5))
   {
     int depth = atoi(goString + 6);
@@ -53,85 +68,104 @@ static void uci_go_parse(Position position, const char goString[])
     return;
   }
 
-  int depth = 4;
-  int nodes = -1;
-  int movetime = -1;
-
-  MoveArray searchmoves;
+  SearchLimits limits;
 
-  memset(searchmoves.moves, MOVE_NONE, sizeof(searchmoves.moves));
-  searchmoves.amount = 0;
+  search_limits_init(&limits);
 
+  limits.multipv = uci_multipv;
 
   char* string;
   
   if((string = strstr(goString, "searchmoves")))
   {
     // Search only on these moves
-    searchmoves = move_strings_parse(position, goString + 12);
+    limits.searchmoves = move_strings_parse(position, string + 12);
   }
-  if(!strncmp(goString, "ponder", 5))
+  if((string = strstr(goString, "ponder")))
   {
-    // This is not implemented
+    // Search the position after the expected move, until ponderhit
+    limits.ponder = true;
   }
   if((string = strstr(goString, "depth")))
   {
     // Search x plies only
-    depth = atoi(string + 6);
+    limits.depth = atoi(string + 6);
   } 
   if((string = strstr(goString, "nodes")))
   {
     // Search x nodes only
-    nodes = atoi(string + 6);
+    limits.nodes = atoi(string + 6);
   }
   if((string = strstr(goString, "mate")))
   {
-    // Search for a mate in x moves
+    // Search for a mate in x moves, before the normal search
+    limits.mate = atoi(string + 5);
   }
   if((string = strstr(goString, "movetime")))
   {
     // Search exactly x milliseconds
-    movetime = atoi(string + 9);
+    limits.movetime = atoi(string + 9);
   }
   if((string = strstr(goString, "infinite")))
   {
-    // This is not implemented
+    // Search until stop
+    limits.infinite = true;
   }
 
-  // int time = -1;
-  // int inc = -1;
-  
   if((string = strstr(goString, "wtime")) && position.side == SIDE_WHITE)
   {
     // White has x milliseconds left on the clock
-    // time = atoi(string + 6);
+    limits.time = atoi(string + 6);
   }
   else if((string = strstr(goString, "btime")) && position.side == SIDE_BLACK)
   {
     // Black has x milliseconds left on the clock
-    // time = atoi(string + 6);
+    limits.time = atoi(string + 6);
   }
 
   if((string = strstr(goString, "winc")) && position.side == SIDE_WHITE)
   {
     // White's increment per move in milliseconds
-    // inc = atoi(string + 5);
+    limits.inc = atoi(string + 5);
   }
   else if((string = strstr(goString, "binc")) && position.side == SIDE_BLACK)
   {
     // Blacks's increment per move in milliseconds
-    // inc = atoi(string + 5);
+    limits.inc = atoi(string + 5);
   }
 
-  // printf("best_move(%d, %d, %d)\n", depth, nodes, movetime);
-  
-  Move bestMove = best_move(position, depth, nodes, movetime, searchmoves);
+  if((string = strstr(goString, "movestogo")))
+  {
+    // There are x moves to the next time control
+    limits.movestogo = atoi(string + 10);
+  }
+
+  // A book move is played at once, but not while pondering or searching infinitely
+  if(!limits.ponder && !limits.infinite && limits.searchmoves.amount == 0)
+  {
+    Move bookMove = book_move_get(&uci_book, position);
+
+    if(bookMove != MOVE_NONE)
+    {
+      char moveString[8];
+      move_string_create(moveString, bookMove);
+
+      printf("bestmove %s\n", moveString);
 
+      fflush(stdout);
 
-  char moveString[8];
-  move_string_create(moveString, bestMove);
+      return;
+    }
+  }
+
+  // Without any limit, the search stops at the default depth
+  if(limits.depth < 0 && limits.nodes < 0 && limits.movetime < 0 &&
+     limits.time  < 0 && !limits.infinite && !limits.ponder)
+  {
+    limits.depth = 4;
+  }
 
-  printf("bestmove %s\n", moveString);
+  uci_search_start(position, &game_history, limits);
 }
 
 /*
@@ -153,12 +187,19 @@ static int uci_position_fen_parse(Position* position, const char* position_strin
 }
 
 /*
+ * Make the moves, and remember the positions before them
+ *
+ * A capture or pawn move clears the history,
+ * because the positions before it can not repeat
+ *
  * RETURN (int status)
  * - 0 | Success
  * - 1 | Failed to parse move
  */
-static int uci_position_moves_parse(Position* position, char* moves_string)
+static int uci_position_moves_parse(Position* position, KeyHistory* history, const char* moves_string)
 {
+  while(*moves_string == ' ') moves_string++;
+
   while(*moves_string)
   {
     Move move = move_string_parse(*position, moves_string);
@@ -168,17 +209,81 @@ static int uci_position_moves_parse(Position* position, char* moves_string)
       return 1;
     }
 
+    key_history_push(history, *position);
+
     move_make(position, move);
 
+    if(position->clock == 0) key_history_clear(history);
+
     while(*moves_string && *moves_string != ' ') moves_string++;
 
-    moves_string++;
+    while(*moves_string == ' ') moves_string++;
   }
 
   return 0;
 }
 
 /*
+ * Get the moves that the position command adds to the last position command,
+ * when it is the same game with more moves, like GUIs send after every move
+ *
+ * RETURN (const char* moves_string)
+ * - NULL | The position command does not continue the last one
+ */
+static const char* uci_position_added_moves_get(const char* position_string)
+{
+  if(!last_position_string) return NULL;
+
+  size_t length = strlen(last_position_string);
+
+  if(strncmp(position_string, last_position_string, length) != 0) return NULL;
+
+  const char* string = position_string + length;
+
+  if(*string != ' ' && *string != '\0') return NULL;
+
+  while(*string == ' ') string++;
+
+  // The last position command had no moves
+  if(strncmp(string, "moves", 5) == 0) string += 5;
+
+  return string;
+}
+
+/*
+ * Remember the position command, so the next one can continue from it
+ */
+static void uci_position_string_store(const char* position_string)
+{
+  size_t size = strlen(position_string) + 1;
+
+  if(size > last_position_size)
+  {
+    char* string = realloc(last_position_string, size);
+
+    if(!string)
+    {
+      free(last_position_string);
+
+      last_position_string = NULL;
+      last_position_size   = 0;
+
+      return;
+    }
+
+    last_position_string = string;
+    last_position_size   = size;
+  }
+
+  memcpy(last_position_string, position_string, size);
+}
+
+/*
+ * Parse position command, ex: position startpos moves e2e4 e7e5
+ *
+ * If the command continues the last position command,
+ * only the added moves are made on the current position
+ *
  * RETURN (int status)
  * - 0 | Success
  * - 1 | Failed to parse position fen
@@ -186,20 +291,31 @@ static int uci_position_moves_parse(Position* position, char* moves_string)
  */
 static int uci_position_parse(Position* position, const char* position_string)
 {
-  Position temp_position;
+  const char* moves_string = uci_position_added_moves_get(position_string);
 
-  if(uci_position_fen_parse(&temp_position, position_string) != 0)
+  Position temp_position = *position;
+
+  KeyHistory temp_history = game_history;
+
+  if(!moves_string)
   {
-    if(args.debug) error_print("Failed to parse position fen");
+    if(uci_position_fen_parse(&temp_position, position_string) != 0)
+    {
+      if(args.debug) error_print("Failed to parse position fen");
 
-    return 1;
-  }
+      return 1;
+    }
 
-  char* moves_string = strstr(position_string, "moves");
+    key_history_clear(&temp_history);
+
+    moves_string = strstr(position_string, "moves");
+
+    if(moves_string) moves_string += 5;
+  }
 
-  if(moves_string != NULL)
+  if(moves_string)
   {
-    if(uci_position_moves_parse(&temp_position, moves_string + 6) != 0)
+    if(uci_position_moves_parse(&temp_position, &temp_history, moves_string) != 0)
     {
       if(args.debug) error_print("Failed to parse position moves");
 
@@ -209,9 +325,67 @@ static int uci_position_parse(Position* position, const char* position_string)
 
   *position = temp_position;
 
+  game_history = temp_history;
+
+  uci_position_string_store(position_string);
+
   return 0;
 }
 
+/*
+ * Parse bench command, with an optional search depth
+ */
+static void uci_bench_parse(const char* bench_string)
+{
+  int depth = (*bench_string) ? atoi(bench_string) : 5;
+
+  if(depth <= 0) depth = 5;
+
+  uci_search_stop();
+
+  if(args.debug) info_print("Start of bench");
+
+  bench_test(depth);
+
+  if(args.debug) info_print("End of bench");
+}
+
+/*
+ * Parse setoption command, ex: setoption name MultiPV value 3
+ *
+ * The Book option is the path of a polyglot book, or <empty> for no book
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Unknown option
+ */
+static int uci_setoption_parse(const char* option_string)
+{
+  if(strncmp(option_string, "name MultiPV value ", 19) == 0)
+  {
+    int multipv = atoi(option_string + 19);
+
+    uci_multipv = (multipv < 1) ? 1 : (multipv > 256) ? 256 : multipv;
+
+    return 0;
+  }
+
+  if(strncmp(option_string, "name Book value ", 16) == 0)
+  {
+    const char* filepath = option_string + 16;
+
+    book_close(&uci_book);
+
+    if(*filepath == '\0' || strcmp(filepath, "<empty>") == 0) return 0;
+
+    return (book_open(&uci_book, filepath) == 0) ? 0 : 1;
+  }
+
+  if(args.debug) error_print("Unknown option: %s", option_string);
+
+  return 1;
+}
+
 /*
  *
  */
@@ -219,6 +393,8 @@ static void uci_uci_handler(void)
 {
   printf("id name TreeStump\n");
   printf("id author Hampus Fridholm\n");
+  printf("option name MultiPV type spin default 1 min 1 max 256\n");
+  printf("option name Book type string default <empty>\n");
   printf("uciok\n");
 }
 
@@ -235,7 +411,7 @@ static void uci_isready_handler(void)
  */
 static void uci_stop_handler(void)
 {
-  printf("bestmove a1a1\n");
+  uci_search_stop();
 }
 
 /*
@@ -243,7 +419,9 @@ static void uci_stop_handler(void)
  */
 static void uci_ucinewgame_handler(void)
 {
+  uci_search_stop();
 
+  hash_table_clear(&hash_table);
 }
 
 /*
@@ -251,7 +429,7 @@ static void uci_ucinewgame_handler(void)
  */
 static void uci_ponderhit_handler(void)
 {
-
+  uci_search_ponderhit();
 }
 
 /*
@@ -259,7 +437,9 @@ static void uci_ponderhit_handler(void)
  */
 static void uci_quit_handler(void)
 {
+  uci_search_stop();
 
+  book_close(&uci_book);
 }
 
 /*
@@ -304,6 +484,14 @@ int uci_parse(Position* position, const char* uci_string)
   {
     uci_go_parse(*position, uci_string + 3);
   }
+  else if(strncmp(uci_string, "setoption", 9) == 0)
+  {
+    uci_setoption_parse(uci_string + 10);
+  }
+  else if(strncmp(uci_string, "bench", 5) == 0)
+  {
+    uci_bench_parse(uci_string + 5);
+  }
   else if(strcmp(uci_string, "d") == 0)
   {
     position_print(*position);
@@ -312,13 +500,13 @@ int uci_parse(Position* position, const char* uci_string)
     for(Piece piece = PIECE_WHITE_PAWN; piece <= PIECE_BLACK_KING; piece++)
     {
       printf("piece: %c\n", PIECE_SYMBOLS[piece]);
-      bitboard_print(position->boards[piece]);
+      bitboard_print(POSITION_BOARD_GET(*position, piece));
     }
 
     for(Side side = SIDE_WHITE; side <= SIDE_BOTH; side++)
     {
       printf("side: %c\n", SIDE_SYMBOLS[side]);
-      bitboard_print(position->covers[side]);
+      bitboard_print(POSITION_COVER_GET(*position, side));
     }
     */
   }
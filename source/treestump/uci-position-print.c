@@ -47,7 +47,7 @@ void position_print(Position position)
 
       if(!file) printf("%d ", BOARD_RANKS - rank);
 
-      int piece = square_piece_get(position.boards, square);
+      int piece = square_piece_get(position, square);
 
       printf("%c ", (piece != PIECE_NONE) ? PIECE_SYMBOLS[piece] : '.');
     }
@@ -0,0 +1,209 @@
+/*
+ * Run the search of the go command in its own thread,
+ * so that stop and ponderhit can be read while searching
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+#include "../treestump.h"
+
+#include "uci-intern.h"
+
+#include <pthread.h>
+
+/*
+ * The search that is running, with its own copy of the position
+ *
+ * The mutex guards the stop and ponder flags of the limits,
+ * and the condition is signaled when they change
+ */
+typedef struct
+{
+  Position        position;
+  KeyHistory      history;
+  SearchLimits    limits;
+  pthread_t       thread;
+  bool            running;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+} UciSearch;
+
+static UciSearch uci_search =
+{
+  .running = false,
+  .mutex   = PTHREAD_MUTEX_INITIALIZER,
+  .cond    = PTHREAD_COND_INITIALIZER
+};
+
+/*
+ * Search for a mate, and print it as the best line
+ *
+ * RETURN (Move move)
+ * - MOVE_NONE | No mate was found, or the search was stopped
+ */
+static Move uci_search_mate(void)
+{
+  int mateMoves = 0;
+
+  long startTime = time_ms_get();
+
+  Move mateMove = mate_move(uci_search.position, &uci_search.limits, &mateMoves);
+
+  if(mateMove == MOVE_NONE)
+  {
+    if(args.debug) info_print("No mate in %d moves", uci_search.limits.mate);
+
+    // The normal search after it only gets the time that is left
+    long usedTime = time_ms_get() - startTime;
+
+    SearchLimits* limits = &uci_search.limits;
+
+    if(limits->movetime >= 0) limits->movetime = (limits->movetime > usedTime) ? (limits->movetime - usedTime) : 1;
+
+    if(limits->time >= 0) limits->time = (limits->time > usedTime) ? (limits->time - usedTime) : 1;
+
+    return MOVE_NONE;
+  }
+
+  char moveString[8];
+  move_string_create(moveString, mateMove);
+
+  printf("info depth %d score mate %d pv %s\n", (mateMoves * 2 - 1), mateMoves, moveString);
+
+  return mateMove;
+}
+
+/*
+ * Search the position, and print the best move
+ *
+ * A mate search is done first, if the limits have one,
+ * and the normal search is only done if it finds no mate
+ *
+ * The best move is not printed while pondering or searching infinitely,
+ * even if the search is done, until the GUI sends stop or ponderhit
+ */
+static void* uci_search_run(void* data)
+{
+  Move ponderMove = MOVE_NONE;
+
+  Move bestMove = (uci_search.limits.mate > 0) ? uci_search_mate() : MOVE_NONE;
+
+  if(bestMove == MOVE_NONE)
+  {
+    bestMove = best_move(uci_search.position, &uci_search.history, &uci_search.limits, &ponderMove);
+  }
+
+  pthread_mutex_lock(&uci_search.mutex);
+
+  while((uci_search.limits.ponder || uci_search.limits.infinite) && !uci_search.limits.stop)
+  {
+    pthread_cond_wait(&uci_search.cond, &uci_search.mutex);
+  }
+
+  pthread_mutex_unlock(&uci_search.mutex);
+
+  char moveString[8];
+  move_string_create(moveString, bestMove);
+
+  if(ponderMove != MOVE_NONE)
+  {
+    char ponderString[8];
+    move_string_create(ponderString, ponderMove);
+
+    printf("bestmove %s ponder %s\n", moveString, ponderString);
+  }
+  else printf("bestmove %s\n", moveString);
+
+  fflush(stdout);
+
+  return NULL;
+}
+
+/*
+ * Start to search the position in the background
+ *
+ * A search that is already running is stopped first
+ */
+void uci_search_start(Position position, const KeyHistory* history, SearchLimits limits)
+{
+  uci_search_stop();
+
+  uci_search.position = position;
+  uci_search.history  = *history;
+  uci_search.limits   = limits;
+
+  if(pthread_create(&uci_search.thread, NULL, uci_search_run, NULL) != 0)
+  {
+    if(args.debug) error_print("Failed to create search thread");
+
+    return;
+  }
+
+  uci_search.running = true;
+}
+
+/*
+ * Stop the running search, and wait for it to print its best move
+ */
+void uci_search_stop(void)
+{
+  if(!uci_search.running) return;
+
+  pthread_mutex_lock(&uci_search.mutex);
+
+  __atomic_store_n(&uci_search.limits.stop, true, __ATOMIC_RELAXED);
+
+  pthread_cond_broadcast(&uci_search.cond);
+
+  pthread_mutex_unlock(&uci_search.mutex);
+
+  pthread_join(uci_search.thread, NULL);
+
+  uci_search.running = false;
+}
+
+/*
+ * Wait for the running search to finish by itself,
+ * but a search that only finishes when told to is stopped
+ */
+void uci_search_wait(void)
+{
+  if(!uci_search.running) return;
+
+  pthread_mutex_lock(&uci_search.mutex);
+
+  if(uci_search.limits.ponder || uci_search.limits.infinite)
+  {
+    __atomic_store_n(&uci_search.limits.stop, true, __ATOMIC_RELAXED);
+
+    pthread_cond_broadcast(&uci_search.cond);
+  }
+
+  pthread_mutex_unlock(&uci_search.mutex);
+
+  pthread_join(uci_search.thread, NULL);
+
+  uci_search.running = false;
+}
+
+/*
+ * The opponent played the expected move,
+ * so the ponder search goes on as a normal search
+ *
+ * The time of the search is counted from the go command,
+ * so the time spent pondering is used for the move
+ */
+void uci_search_ponderhit(void)
+{
+  if(!uci_search.running) return;
+
+  pthread_mutex_lock(&uci_search.mutex);
+
+  __atomic_store_n(&uci_search.limits.ponder, false, __ATOMIC_RELAXED);
+
+  pthread_cond_broadcast(&uci_search.cond);
+
+  pthread_mutex_unlock(&uci_search.mutex);
+}
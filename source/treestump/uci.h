@@ -1,7 +1,7 @@
 /*
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-09-08
+ * Last updated: 2026-10-19
  */
 
 #ifndef UCI_H
@@ -11,11 +11,40 @@
 
 extern const char* FEN_START;
 
+#define FEN_STRING_SIZE 128
+
+/*
+ * A packed position file, mapped into memory
+ */
+typedef struct
+{
+  const PackedPosition* records;
+  size_t                amount;
+  size_t                size;
+} PackedFile;
+
 
 extern int fen_parse(Position* position, const char* fen_string);
 
+extern char* fen_create(char* string, Position position);
+
+extern Position* fens_file_load(const char* filepath, size_t* amount, size_t** line_numbers, int thread_amount);
+
+
+extern int  fens_file_pack(const char* input, const char* output);
+
+extern int  packed_file_unpack(const char* input, const char* output);
+
+extern int  packed_file_open(PackedFile* file, const char* filepath);
+
+extern void packed_file_close(PackedFile* file);
+
+extern const PackedPosition* packed_file_position_get(Position* position, const PackedFile* file, size_t index);
+
 extern int uci_parse(Position* position, const char* uci_string);
 
+extern void uci_search_wait(void);
+
 
 extern char* move_string_create(char* string, Move move);
 